@@ -0,0 +1,56 @@
+// Compares Rect::collidelistall (SIMD batches, see CollideRects in rygame_cl_Rect.cpp) with
+// calling Rect::colliderect on each rect. Build with -DRYGAME_BUILD_BENCH=ON, and add -mavx
+// to CMAKE_CXX_FLAGS to measure the AVX path instead of SSE2.
+#include "rygame.hpp"
+#include <chrono>
+#include <cstdio>
+
+
+int main(const int argc, char *argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> position(0.0f, 10000.0f);
+    std::uniform_real_distribution<float> size(1.0f, 64.0f);
+    std::vector<rg::Rect> rects(count);
+    for (auto &rect: rects)
+    {
+        rect = {position(generator), position(generator), size(generator), size(generator)};
+    }
+    const rg::Rect probe{4000, 4000, 500, 500};
+
+    using Clock = std::chrono::steady_clock;
+    size_t scalar_hits = 0, simd_hits = 0;
+    const auto scalar_start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const auto &rect: rects)
+        {
+            scalar_hits += probe.colliderect(rect);
+        }
+    }
+    const std::chrono::duration<double> scalar = Clock::now() - scalar_start;
+
+    const auto simd_start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        simd_hits += probe.collidelistall(rects).size();
+    }
+    const std::chrono::duration<double> simd = Clock::now() - simd_start;
+
+#if defined(__AVX__)
+    const char *path = "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+    const char *path = "SSE2";
+#else
+    const char *path = "scalar";
+#endif
+    std::printf("%zu rects x %d rounds\n", count, rounds);
+    std::printf("colliderect loop: %8.2f ms (%zu hits)\n", scalar.count() * 1000, scalar_hits);
+    std::printf(
+            "collidelistall (%s): %8.2f ms (%zu hits), %.2fx\n", path, simd.count() * 1000,
+            simd_hits, scalar.count() / simd.count());
+    return scalar_hits == simd_hits ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 // ReSharper disable CppClassCanBeFinal
 #pragma once
 #include <functional>
+#include <iterator>
 #include <list>
 #include <utility>
 #include <vector>
@@ -10,7 +11,9 @@
 #include <filesystem>
 #include <ctime>
 #include <map>
+#include <unordered_map>
 #include <random>
+#include <cstdint>
 
 namespace rl
 {
@@ -364,6 +367,36 @@ namespace rg
                 Line line, math::Vector2 *collisionPoint1, math::Vector2 *collisionPoint2) const;
         // Returns true if other rect overlaps this one
         [[nodiscard]] bool colliderect(const Rect &other) const;
+        // Returns the index of the first rect in `rects` that overlaps this one, or -1
+        [[nodiscard]] int collidelist(const std::vector<Rect> &rects) const;
+        // Returns the indexes of all rects in `rects` that overlap this one
+        [[nodiscard]] std::vector<int> collidelistall(const std::vector<Rect> &rects) const;
+        // Returns an iterator to the first {key, Rect} in `dict` that overlaps this one, or
+        // dict.end()
+        template<typename Map>
+        auto collidedict(Map &dict) const -> decltype(dict.begin())
+        {
+            const auto found = collidedictall(dict);
+            return found.empty() ? dict.end() : found[0];
+        }
+        // Returns iterators to all {key, Rect} in `dict` that overlap this one
+        template<typename Map>
+        auto collidedictall(Map &dict) const -> std::vector<decltype(dict.begin())>
+        {
+            std::vector<Rect> rects;
+            std::vector<decltype(dict.begin())> items;
+            for (auto it = dict.begin(); it != dict.end(); ++it)
+            {
+                rects.push_back(it->second);
+                items.push_back(it);
+            }
+            std::vector<decltype(dict.begin())> result;
+            for (const int index: collidelistall(rects))
+            {
+                result.push_back(items[index]);
+            }
+            return result;
+        }
         // If passed line crosses the rect, returns a new line that is just inside the rect
         // If passed line is outside, returns an empty line {}
         Line clipline(Line line);
@@ -378,6 +411,11 @@ namespace rg
 #pragma GCC diagnostic pop
 #endif
 
+    namespace mask
+    {
+        class Mask;
+    } // namespace mask
+
     class Surface;
     using Surface_Ptr = std::shared_ptr<Surface>;
 
@@ -391,6 +429,9 @@ namespace rg
         Surface(int width, int height);
         explicit Surface(math::Vector2 size);
         explicit Surface(rl::Texture2D *texture, Rect atlas = {});
+        // View of `rect` inside `parent_surface`. It shares the parent render, so no new
+        // render is allocated. Parent will be kept alive while the view exists.
+        Surface(const Surface_Ptr &parent_surface, Rect rect);
 
         // Unloads render
         virtual ~Surface();
@@ -432,9 +473,16 @@ namespace rg
 
         // Returns shared_texture if exists, render.texture otherwise.
         [[nodiscard]] rl::Texture2D GetTexture() const;
+        // Area of GetTexture() that is drawn when this is blitted. A negative width/height
+        // means that the area is drawn mirrored in that axis.
+        [[nodiscard]] Rect GetSourceRect() const;
 
         // Ends current render, sets this render as current
         void ToggleRender();
+        // Returns the mask of this surface (alpha > 127). It is created on first call and
+        // reused until something is drawn into its render (this surface, its parent or any
+        // view sharing the render).
+        virtual std::shared_ptr<mask::Mask> GetMask();
 
         rl::RenderTexture2D render{};
         Rect atlas_rect{}; // atlas position
@@ -448,6 +496,12 @@ namespace rg
         Surface_Ptr parent = nullptr;
         math::Vector2 offset{};
         float flip_atlas_height = 1; // 1 or -1 (Frames)
+        // created by GetMask(), one per frame in Frames. Valid while draw_count is
+        // masks_draw_count.
+        std::vector<std::shared_ptr<mask::Mask>> cached_masks{};
+        // draws into the render, shared with the views (SubSurface, SubFrames) of the render
+        std::shared_ptr<unsigned int> draw_count = std::make_shared<unsigned int>(0);
+        unsigned int masks_draw_count = 0;
 
         rl::Color tint{255, 255, 255, 255};
     };
@@ -467,6 +521,9 @@ namespace rg
         // size (Width/Cols, Height/Rows)
         Frames(int width, int height, int rows, int cols);
         Frames(const Surface_Ptr &surface, int rows, int cols);
+        // View of `rect` inside `parent_frames`, keeping only the frames that collide with
+        // `rect`. It shares the parent render, so no new render is allocated.
+        Frames(const Frames_Ptr &parent_frames, Rect rect);
 
         // Set current atlas rect. Default to first frame.
         // Value is moduled with frame length in case it is greater than frames size.
@@ -486,6 +543,8 @@ namespace rg
         // as this one. SubSurface will have this as parent (GetParent, GetAbsParent).
         // SubSurface will have its frames updated.
         Frames_Ptr SubFrames(Rect rect);
+        // Returns the mask of the current frame
+        std::shared_ptr<mask::Mask> GetMask() override;
 
         int current_frame_index{};
         std::vector<Rect> frames{};
@@ -497,6 +556,97 @@ namespace rg
         void CreateFrames(int width, int height, int rows, int cols);
     };
 
+    namespace animation
+    {
+        enum PlayMode
+        {
+            ONCE = 0, // stops at the last frame
+            LOOP, // restarts from the first frame
+            PINGPONG // plays forward, then backward
+        };
+
+        // Sequence of frame indexes (into Frames::frames) and how long each one lasts.
+        // A Clip holds no playback state, so one Clip is shared by all instances playing it.
+        class Clip
+        {
+        public:
+
+            Clip() = default;
+            // Frames from `first_frame` to `last_frame` (inclusive), each one lasting
+            // `frame_duration` seconds
+            Clip(int first_frame, int last_frame, float frame_duration, PlayMode mode = LOOP);
+            // `durations` (seconds) must have one entry per frame index
+            Clip(const std::vector<int> &frame_indexes, const std::vector<float> &durations,
+                 PlayMode mode = LOOP);
+
+            // Time (seconds) for the clip to return to its initial state.
+            // Returns 0 if the clip never changes frame.
+            [[nodiscard]] float CycleDuration() const;
+
+            std::vector<int> frame_indexes{};
+            std::vector<float> durations{};
+            PlayMode mode = LOOP;
+        };
+        using Clip_Ptr = std::shared_ptr<Clip>;
+
+        // Plays many animation instances at once. Instances state is kept in contiguous arrays
+        // and all of them are advanced in a single pass in Update(), instead of each Sprite
+        // keeping its own timer.
+        class Animator
+        {
+        public:
+
+            // Animator cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            Animator() = default;
+
+            // Registers a clip and returns its id. Clips can't be changed after being added.
+            int AddClip(const Clip_Ptr &clip);
+            // Creates an instance playing `clip_id` from the start and returns its id
+            unsigned int Add(int clip_id, float speed = 1.0f);
+            // Removes instance, its id can be reused by a future Add()
+            void Remove(unsigned int instance);
+            // Removes all instances, keeps clips
+            void Clear();
+            // Changes the clip being played. If it is the same clip, restarts only if `restart`
+            void Play(unsigned int instance, int clip_id, bool restart = false);
+            // Playback speed multiplier, 0 pauses the instance
+            void SetSpeed(unsigned int instance, float speed);
+            // Advances all instances by deltaTime seconds
+            void Update(float deltaTime);
+            // Returns the current frame index (into Frames::frames) of instance
+            [[nodiscard]] int GetFrame(unsigned int instance) const;
+            // True if a ONCE clip reached its last frame
+            [[nodiscard]] bool IsFinished(unsigned int instance) const;
+            // Sets the atlas of `frames` to the current frame of instance
+            void Apply(unsigned int instance, const Frames_Ptr &frames) const;
+            // Number of instances
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            [[nodiscard]] bool IsValid(unsigned int instance) const;
+
+            std::vector<Clip_Ptr> clips{};
+            std::vector<float> clip_cycles{}; // cached Clip::CycleDuration()
+
+            // one entry per instance, in dense order
+            std::vector<int> clip_ids{};
+            std::vector<int> steps{}; // position inside clip frame_indexes
+            std::vector<signed char> directions{}; // 1 or -1 (PINGPONG)
+            std::vector<float> times{}; // time spent on current step
+            std::vector<float> speeds{};
+            std::vector<int> current_frames{};
+            std::vector<unsigned char> finished{};
+
+            // instance id -> dense position and dense position -> instance id
+            std::vector<unsigned int> sparse{};
+            std::vector<unsigned int> dense_ids{};
+            std::vector<unsigned int> free_ids{};
+        };
+    } // namespace animation
+
     namespace image
     {
         // Load a file into a new Surface*
@@ -552,12 +702,230 @@ namespace rg
         // get the tile image from the tileset
         rl::Texture2D *GetTMXTileTexture(const rl::tmx_tile *tile, Rect *atlas_rect);
         // get a vector with tile info (position on the layer and surface image)
-        std::vector<TileInfo> GetTMXTiles(const rl::tmx_map *map, const rl::tmx_layer *layer);
+        // If `skip_animated`, tiles with animation are not included (see AnimatedTiles)
+        std::vector<TileInfo> GetTMXTiles(
+                const rl::tmx_map *map, const rl::tmx_layer *layer, bool skip_animated = false);
         // merges all tiles into one single surface image
-        Surface_Ptr GetTMXLayerSurface(const rl::tmx_map *map, const rl::tmx_layer *layer);
+        // If `skip_animated`, tiles with animation are not merged (see AnimatedTiles)
+        Surface_Ptr GetTMXLayerSurface(
+                const rl::tmx_map *map, const rl::tmx_layer *layer, bool skip_animated = false);
         math::Vector2 GetTMXObjPosition(const rl::tmx_object *object);
-        // Load all tmx in a folder
+
+        // Compact tile of a layer (8 bytes). Texture and atlas are looked up by gid in a
+        // TileTable. Layers up to 65535 tiles per side.
+        struct TileRef
+        {
+            uint16_t x = 0; // column in the layer
+            uint16_t y = 0; // row in the layer
+            uint32_t gid = 0; // without flip bits
+        };
+
+        // Texture, atlas and placement of each gid of a map, built once and shared by all
+        // layers of the map
+        class TileTable
+        {
+        public:
+
+            // TileTable cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            struct Entry
+            {
+                rl::Texture2D *texture = nullptr;
+                Rect atlas_rect{};
+                math::Vector2 tile_size{}; // tileset tile size, tiles are placed by it
+            };
+
+            explicit TileTable(const rl::tmx_map *map);
+
+            // nullptr if gid has no tile
+            [[nodiscard]] const Entry *Get(uint32_t gid) const;
+            // Position of `tile` on the layer, same as GetTMXTiles
+            [[nodiscard]] math::Vector2 GetPosition(const TileRef &tile) const;
+
+        private:
+
+            std::vector<Entry> entries{}; // by gid
+        };
+
+        // Tiles of a layer with any gid, as TileRef
+        std::vector<TileRef> GetTMXTileRefs(const rl::tmx_map *map, const rl::tmx_layer *layer);
+
+        // Tiles of `layer` whose cell is inside `area` (plus one cell up and left, for tiles
+        // bigger than the map grid), read directly from the layer gids without storing them.
+        //  for (const TileRef &tile: VisibleTiles(map, layer, camera))
+        class VisibleTiles
+        {
+        public:
+
+            // VisibleTiles cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            class iterator
+            {
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = TileRef;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const TileRef *;
+                using reference = const TileRef &;
+
+                reference operator*() const;
+                pointer operator->() const;
+                iterator &operator++();
+                bool operator==(const iterator &other) const;
+                bool operator!=(const iterator &other) const;
+
+            private:
+
+                friend class VisibleTiles;
+                iterator(const VisibleTiles *range, int x, int y);
+                // moves to the first cell with a tile at or after the current one
+                void SkipEmpty();
+
+                const VisibleTiles *range;
+                TileRef current{};
+                int x;
+                int y;
+            };
+
+            VisibleTiles(const rl::tmx_map *map, const rl::tmx_layer *layer, const Rect &area);
+
+            [[nodiscard]] iterator begin() const;
+            [[nodiscard]] iterator end() const;
+
+        private:
+
+            const rl::tmx_map *map;
+            const rl::tmx_layer *layer;
+            // cells inside area, empty if x0 > x1
+            int x0{}, y0{}, x1 = -1, y1 = -1;
+        };
+
+        // Draws the tiles of `layer` inside `area` into `surface`, moved by `offset`
+        // (e.g. -camera). Nothing is stored per tile.
+        void DrawTMXTiles(
+                const Surface_Ptr &surface, const TileTable &table, const rl::tmx_map *map,
+                const rl::tmx_layer *layer, const Rect &area, math::Vector2 offset = {});
+        // Load all .tmx files in a folder. Files are parsed in parallel, textures are loaded
+        // in this thread. Unload each map with rl::UnloadTMX.
         std::map<std::string, rl::tmx_map *> LoadTMXMaps(const char *path);
+
+        // Owns all .tmx maps in a folder. Tileset images used by many maps are loaded into a
+        // single texture shared by them. Maps and textures are unloaded with the library.
+        class MapLibrary
+        {
+        public:
+
+            // MapLibrary cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            // If `lazy`, files are only listed and each map is parsed on its first Get.
+            // Otherwise all maps are parsed in parallel.
+            explicit MapLibrary(const char *path, bool lazy = false);
+            ~MapLibrary();
+            MapLibrary(const MapLibrary &) = delete;
+            MapLibrary &operator=(const MapLibrary &) = delete;
+
+            // Map file `name` (without extension), parsed if needed. nullptr if there is no
+            // such file or it can't be parsed.
+            rl::tmx_map *Get(const std::string &name);
+            // Parses, in parallel, all maps not parsed yet
+            void LoadAll();
+            [[nodiscard]] bool has(const std::string &name) const;
+            [[nodiscard]] bool IsLoaded(const std::string &name) const;
+            [[nodiscard]] std::vector<std::string> Names() const;
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            void LoadTextures(rl::tmx_map *map);
+
+            std::map<std::string, std::string> files{}; // name -> path
+            std::map<std::string, rl::tmx_map *> maps{}; // parsed maps, nullptr if it failed
+            std::unordered_map<std::string, rl::Texture2D *> textures{}; // image path -> texture
+        };
+
+        // Layer merged into square chunks (chunk_size pixels) instead of one map sized
+        // surface. Only the chunks around the camera are kept in memory.
+        class ChunkedLayer
+        {
+        public:
+
+            // ChunkedLayer cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            // `margin` is how many chunks around the camera are created ahead
+            // If `skip_animated`, tiles with animation are not merged (see AnimatedTiles)
+            ChunkedLayer(
+                    const rl::tmx_map *map, const rl::tmx_layer *layer, int chunk_size = 512,
+                    int margin = 1, bool skip_animated = false);
+
+            // Creates the chunks around `camera` and unloads the ones far from it
+            void Update(const Rect &camera);
+            // Draws the chunks in `camera` into `surface`, camera top left at surface 0,0.
+            // Chunks not created by Update are skipped.
+            void Draw(const Surface_Ptr &surface, const Rect &camera) const;
+            // Chunk cx,cy, created if needed. nullptr if it is outside the map.
+            Surface_Ptr GetChunk(int cx, int cy);
+            // Number of chunks in memory
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            [[nodiscard]] Surface_Ptr Bake(int cx, int cy) const;
+            // Chunks touching `area`, false if none
+            bool ChunkRange(const Rect &area, int *cx0, int *cy0, int *cx1, int *cy1) const;
+            [[nodiscard]] static int64_t Key(int cx, int cy);
+
+            const rl::tmx_map *map;
+            const rl::tmx_layer *layer;
+            int chunk_size;
+            int margin;
+            bool skip_animated;
+            int cols;
+            int rows;
+            std::unordered_map<int64_t, Surface_Ptr> chunks{};
+        };
+
+        // Animated tiles of a layer, grouped by animation. Draw them over the layer merged
+        // with `skip_animated`. All tiles of an animation show the same frame, so Update
+        // only advances each animation once and Draw blits its tiles in one batch.
+        class AnimatedTiles
+        {
+        public:
+
+            // AnimatedTiles cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            AnimatedTiles(const rl::tmx_map *map, const rl::tmx_layer *layer);
+
+            void Update(float deltaTime);
+            // Draws the animated tiles inside `area` into `surface`, moved by `offset`
+            // (e.g. -camera)
+            void Draw(
+                    const Surface_Ptr &surface, const Rect &area, math::Vector2 offset = {}) const;
+            // Number of animated tiles
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            struct Animation
+            {
+                std::vector<rl::Texture2D *> textures{}; // per frame
+                std::vector<Rect> atlas_rects{}; // per frame
+                std::vector<float> durations{}; // per frame, in seconds
+                // tiles with this animation, sorted by y then x
+                std::vector<math::Vector2> positions{};
+                math::Vector2 tile_size{}; // biggest frame
+                float cycle = 0.0f; // sum of durations
+                unsigned int frame = 0;
+                float time = 0.0f; // in current frame
+            };
+
+            std::vector<Animation> animations{};
+        };
     } // namespace tmx
 #endif // WITH_TMX
 
@@ -634,6 +1002,8 @@ namespace rg
 
             Rect rect{}; // world position
             Surface_Ptr image;
+            // Used by collide_mask. If not set, collide_mask uses image->GetMask()
+            std::shared_ptr<mask::Mask> mask = nullptr;
 
         protected:
 
@@ -653,6 +1023,9 @@ namespace rg
         };
 
         bool collide_rect(const Sprite_Ptr &left, const Sprite_Ptr &right);
+        // Pixel perfect collision. Tests the rects first, then the masks of both sprites
+        // (Sprite::mask if set, otherwise the cached mask of Sprite::image)
+        bool collide_mask(const Sprite_Ptr &left, const Sprite_Ptr &right);
 
         class CollideCallable
         {
@@ -695,8 +1068,14 @@ namespace rg
                         collide_rect);
     } // namespace sprite
 
+    namespace time
+    {
+        class Scheduler;
+    } // namespace time
+
     // Remains active for certain duration, can repeat once it is done, can autostart
-    // and calls a func at the end. Remember to call Update() on every frame
+    // and calls a func at the end. Remember to call Update() on every frame, unless the
+    // timer is registered in a time::Scheduler.
     class Timer
     {
     public:
@@ -712,18 +1091,34 @@ namespace rg
         explicit
         Timer(float duration, bool repeat = false, bool autostart = false,
               const std::function<void()> &func = nullptr);
+        // Copies are not registered in any Scheduler
+        Timer(const Timer &other);
+        // Keeps this timer Scheduler, if any
+        Timer &operator=(const Timer &other);
+        ~Timer();
         void Activate();
         void Deactivate();
+        // Does nothing if registered, the scheduler ends the timer
         void Update();
+        // `scheduler` ends the timer instead of Update(). It must outlive the timer.
+        void Register(time::Scheduler &scheduler);
+        void Unregister();
         bool active{};
         float duration;
 
     private:
 
+        // Schedules the end of the timer, `delay` seconds from now
+        void ScheduleEnd(float delay);
+        void CancelEnd();
+        void End();
+
         bool repeat{};
         bool autostart{};
         std::function<void()> func;
         double start_time{};
+        time::Scheduler *scheduler = nullptr;
+        uint64_t scheduled = 0; // handle in scheduler, 0 if none
     };
 
     namespace display
@@ -745,10 +1140,70 @@ namespace rg
             // Gets frame time, sets FPS if passed value
             static float tick(int fps = 0.0f);
         };
+
+        // Hierarchical timer wheel. Level 0 has 256 slots of `resolution` seconds, each slot
+        // of the next levels spans a whole turn of the level below (4 levels). Scheduling,
+        // cancelling and firing are O(1), Update cost doesn't grow with pending callbacks.
+        class Scheduler
+        {
+        public:
+
+            // Scheduler cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            explicit Scheduler(float resolution = 1.0f / 120.0f);
+            Scheduler(const Scheduler &) = delete;
+            Scheduler &operator=(const Scheduler &) = delete;
+
+            // Calls `func` after `delay` seconds, then every `interval` seconds if it is
+            // positive. Returns a handle to cancel it, never 0.
+            uint64_t Schedule(
+                    float delay, const std::function<void()> &func, float interval = 0.0f);
+            // Handles already fired or cancelled are ignored
+            void Cancel(uint64_t handle);
+            [[nodiscard]] bool IsPending(uint64_t handle) const;
+            // Advances `deltaTime` seconds, calls what is due tick by tick. Callbacks are never
+            // called early, at most one tick late.
+            void Update(float deltaTime);
+            // Seconds advanced since creation
+            [[nodiscard]] double GetTime() const;
+            // Number of pending callbacks
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            struct Node
+            {
+                std::function<void()> func;
+                uint64_t expiry; // tick
+                uint64_t interval; // ticks, 0 if it doesn't repeat
+                uint32_t generation;
+                int prev, next; // in slot list, -1 at the ends
+                int slot; // -1 if not pending
+            };
+
+            void Insert(int index);
+            void Unlink(int index);
+            // Moves nodes of `slot` to the slots they belong now
+            void Cascade(int slot);
+            void RunTick();
+            [[nodiscard]] int Find(uint64_t handle) const;
+
+            float resolution;
+            double elapsed = 0.0;
+            uint64_t current = 0; // last tick run
+            unsigned int pending = 0;
+            std::vector<int> heads; // first node of each slot
+            std::vector<Node> nodes{};
+            std::vector<int> free_nodes{};
+        };
     } // namespace time
 
     namespace mask
     {
+        // Bit-packed mask, one bit per pixel (like pygame's bitmask). Each row is stored top
+        // to bottom in 64 bits words, bit 0 of a word is its leftmost pixel. Bits past the
+        // mask width are always 0.
         class Mask
         {
         public:
@@ -757,20 +1212,317 @@ namespace rg
             void *operator new(size_t) = delete;
 
             Mask(unsigned int width, unsigned int height, bool fill = false);
-            ~Mask();
+            // Creates a Surface with set bits as white and unset as black
             [[nodiscard]] Surface_Ptr ToSurface() const;
             [[nodiscard]] Frames_Ptr ToFrames(int rows, int cols) const;
 
-            rl::Image image{};
-            Rect atlas_rect{};
+            [[nodiscard]] math::Vector2 get_size() const;
+            [[nodiscard]] Rect get_rect() const;
+            // Returns false if x,y is outside the mask
+            [[nodiscard]] bool get_at(int x, int y) const;
+            // Does nothing if x,y is outside the mask
+            void set_at(int x, int y, bool value = true);
+            // Sets all bits
+            void fill();
+            // Unsets all bits
+            void clear();
+            // Returns true if `other`, placed at `offset` from this mask top left, has any set
+            // bit over a set bit of this mask. If passed, `point` receives the first
+            // overlapping position (in this mask coordinates, scanning rows top to bottom)
+            [[nodiscard]] bool
+            overlap(const Mask &other, math::Vector2 offset, math::Vector2 *point = nullptr) const;
+            // Number of set bits overlapping between this and `other` placed at `offset`
+            [[nodiscard]] unsigned int overlap_area(const Mask &other, math::Vector2 offset) const;
+            // Returns a Mask of this size with only the bits overlapping `other` placed at
+            // `offset`
+            [[nodiscard]] Mask overlap_mask(const Mask &other, math::Vector2 offset) const;
+            // Sets the bits of `other`, placed at `offset`, into this mask (OR)
+            void draw(const Mask &other, math::Vector2 offset);
+            // Unsets the bits of `other`, placed at `offset`, from this mask (AND NOT)
+            void erase(const Mask &other, math::Vector2 offset);
+            // Flips all bits
+            void invert();
+            // Returns a new Mask resized to `size` (nearest neighbor)
+            [[nodiscard]] Mask scale(math::Vector2 size) const;
+            // Number of set bits
+            [[nodiscard]] unsigned int count() const;
+            // Average position of the set bits, {0,0} if there are none
+            [[nodiscard]] math::Vector2 centroid() const;
+            // Points around the border of the first set region (scanning rows top to bottom),
+            // in clockwise order. Only one of each `every` points is returned.
+            [[nodiscard]] std::vector<math::Vector2> outline(int every = 1) const;
+            // Bounding rect of each connected region (8 neighbors)
+            [[nodiscard]] std::vector<Rect> get_bounding_rects() const;
+            // One Mask (this size) per connected region (8 neighbors) with at least `min` bits
+            [[nodiscard]] std::vector<Mask> connected_components(unsigned int min = 0) const;
+
+            // Words of row `y`, there are `words_per_row` of them
+            [[nodiscard]] const uint64_t *Row(int y) const;
+            uint64_t *Row(int y);
+            [[nodiscard]] unsigned int WordsPerRow() const;
+
+            Rect atlas_rect{}; // area of the source texture this mask was created from
+
+        private:
+
+            unsigned int width{};
+            unsigned int height{};
+            unsigned int words_per_row{};
+            std::vector<uint64_t> bits{};
+        };
+
+        // One Mask per frame of a Frames, all of them created from a single texture read
+        class MaskSet
+        {
+        public:
+
+            // MaskSet cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            explicit MaskSet(const Frames_Ptr &frames, unsigned char threshold = 127);
+
+            // Mask of frame_index. Value is moduled with masks size, same as Frames::SetAtlas.
+            // An empty mask (0x0) if there are no masks.
+            [[nodiscard]] const std::shared_ptr<Mask> &Get(int frame_index) const;
+            // Mask of the current frame of `frames`
+            [[nodiscard]] const std::shared_ptr<Mask> &Current(const Frames_Ptr &frames) const;
+            [[nodiscard]] unsigned int size() const;
+
+            std::vector<std::shared_ptr<Mask>> masks{};
         };
 
         Mask FromSurface(const Surface_Ptr &surface, unsigned char threshold = 127);
         Mask FromSurface(const Frames_Ptr &frames, unsigned char threshold = 127);
+        // Creates a mask of `area` inside `image`, set where alpha > threshold. Empty area
+        // uses the whole image. Negative area width/height read that axis mirrored.
+        // GRAYSCALE images use the gray value as alpha.
+        Mask FromImage(const rl::Image &image, Rect area = {}, unsigned char threshold = 127);
+        // Creates a mask with the pixels of `image` where each channel is within `threshold`
+        // of `color` (|pixel - color| < threshold)
+        Mask FromThreshold(
+                const rl::Image &image, rl::Color color, rl::Color threshold = {1, 1, 1, 255});
+        // Creates a mask from an image file, without using the GPU
+        Mask Load(const char *file, unsigned char threshold = 127);
+        // FromSurface reads each texture from the GPU only once and keeps its alpha channel.
+        // Drops the data of `texture_id`, or all of them if 0. Surfaces call this when they
+        // are drawn into.
+        void ClearCache(unsigned int texture_id = 0);
     } // namespace mask
 
+    namespace collision
+    {
+        // Uniform grid of cells (cell_size x cell_size), each one has the ids of the rects that
+        // touch it. Used as a broad phase to find which rects may touch an area.
+        class SpatialGrid
+        {
+        public:
+
+            // SpatialGrid cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            explicit SpatialGrid(float cell_size = 64.0f);
+
+            // Replaces all items with `rects`, the id of each rect is its index
+            void Build(const std::vector<Rect> &rects);
+            // Replaces all items with the sprites rects, the id of each sprite is its index
+            void Build(const std::vector<sprite::Sprite_Ptr> &sprites);
+            void Insert(unsigned int id, const Rect &rect);
+            void Clear();
+            // Ids of the items in the cells touched by `area`, without duplicates. Items may
+            // not collide with `area`, test them after. Keeps no state, so concurrent queries
+            // are safe.
+            [[nodiscard]] std::vector<unsigned int> Query(const Rect &area) const;
+            // Ids in cell (cell_x, cell_y), nullptr if the cell is empty
+            [[nodiscard]] const std::vector<unsigned int> *Cell(int cell_x, int cell_y) const;
+            [[nodiscard]] float GetCellSize() const;
+            // Area covered by all inserted items
+            [[nodiscard]] Rect GetBounds() const;
+
+        private:
+
+            [[nodiscard]] static int64_t Key(int cell_x, int cell_y);
+
+            float cell_size;
+            std::unordered_map<int64_t, std::vector<unsigned int>> cells{};
+            Rect bounds{};
+            bool has_items = false;
+        };
+
+        struct Ray
+        {
+            math::Vector2 origin{};
+            math::Vector2 direction{}; // doesn't need to be normalized
+            float max_distance = 1e9f;
+        };
+
+        struct RayHit
+        {
+            bool hit = false;
+            float distance = 0.0f; // from ray origin
+            math::Vector2 point{};
+            int index = -1; // rect index for rects raycasts
+        };
+
+        // First rect hit by each ray. `grid` must have been built with `rects`, only the cells
+        // crossed by each ray are tested.
+        std::vector<RayHit> Raycast(
+                const std::vector<Ray> &rays, const std::vector<Rect> &rects,
+                const SpatialGrid &grid);
+        // First set pixel of `mask`, placed with its top left at `offset`, hit by each ray.
+        // Walks the pixels crossed by each ray (DDA).
+        std::vector<RayHit>
+        Raycast(const std::vector<Ray> &rays, const mask::Mask &mask, math::Vector2 offset = {});
+        // True if no set pixel of `mask` (placed at `offset`) is between `from` and `to`
+        bool LineOfSight(
+                math::Vector2 from, math::Vector2 to, const mask::Mask &mask,
+                math::Vector2 offset = {});
+
+        struct SweepHit
+        {
+            bool hit = false;
+            // fraction of the velocity moved before the contact [0, 1]. It is 0 if the rects
+            // already overlap
+            float time = 1.0f;
+            // side of the hit rect that was touched, {0, 0} if there was no hit
+            math::Vector2 normal{};
+            // top left of the moving rect at the contact, or after the whole move if there
+            // was no hit
+            math::Vector2 position{};
+            int index = -1; // hit rect index for rects sweeps
+        };
+
+        // Moves `rect` by `velocity` and returns where it first touches `other`. Doesn't
+        // tunnel through `other`, no matter how fast `rect` is.
+        SweepHit Sweep(const Rect &rect, math::Vector2 velocity, const Rect &other);
+        // First rect in `rects` touched by `rect` moving by `velocity`. `grid` must have been
+        // built with `rects`, only rects around the swept area are tested.
+        SweepHit Sweep(
+                const Rect &rect, math::Vector2 velocity, const std::vector<Rect> &rects,
+                const SpatialGrid &grid);
+        // Moves `rect` by `velocity`, stopping at the contacts and sliding along them, up to
+        // `max_slides` contacts. Returns the first contact.
+        SweepHit Slide(
+                Rect &rect, math::Vector2 velocity, const std::vector<Rect> &rects,
+                const SpatialGrid &grid, int max_slides = 3);
+
+        // Solid flag per tile, packed as one bit per tile in a Mask. Queries only read the
+        // tiles under the tested area.
+        class TileGrid
+        {
+        public:
+
+            // TileGrid cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            TileGrid(unsigned int width, unsigned int height, math::Vector2 tile_size);
+#ifdef WITH_TMX
+            // Tiles in `layer` are solid. Uses the map tile size and the layer offset.
+            TileGrid(const rl::tmx_map *map, const rl::tmx_layer *layer);
+#endif
+
+            // Returns false if x,y is outside the grid
+            [[nodiscard]] bool get_at(int x, int y) const;
+            // Does nothing if x,y is outside the grid
+            void set_at(int x, int y, bool solid = true);
+            // Returns true if any solid tile overlaps `rect`
+            [[nodiscard]] bool collide(const Rect &rect) const;
+            // Rects of the solid tiles that overlap `area`
+            [[nodiscard]] std::vector<Rect> GetRects(const Rect &area) const;
+            [[nodiscard]] Rect GetTileRect(int x, int y) const;
+            // Size in tiles
+            [[nodiscard]] math::Vector2 get_size() const;
+            [[nodiscard]] math::Vector2 GetTileSize() const;
+
+            math::Vector2 position{}; // position of tile 0,0
+
+        private:
+
+            // Tiles overlapping `area`, false if none
+            bool TileRange(const Rect &area, int *x0, int *y0, int *x1, int *y1) const;
+
+            mask::Mask tiles;
+            math::Vector2 tile_size{};
+        };
+
+        // First solid tile of `tiles` touched by `rect` moving by `velocity`. Only the tiles
+        // around the swept area are tested.
+        SweepHit Sweep(const Rect &rect, math::Vector2 velocity, const TileGrid &tiles);
+        // Same as Slide with rects, against the solid tiles of `tiles`. SweepHit index is
+        // y * width + x of the tile.
+        SweepHit
+        Slide(Rect &rect, math::Vector2 velocity, const TileGrid &tiles, int max_slides = 3);
+    } // namespace collision
+
+#ifdef WITH_TMX
+    namespace tmx
+    {
+        // Custom property of a tmx object, copied from the map
+        struct Property
+        {
+            rl::tmx_property_type type = rl::PT_NONE;
+            int integer = 0; // PT_INT, PT_BOOL and PT_OBJECT (object id)
+            float decimal = 0.0f; // PT_FLOAT
+            std::string string{}; // PT_STRING and PT_FILE
+            rl::Color color{}; // PT_COLOR
+        };
+
+        // Object of an object layer, with position and properties already resolved
+        struct Object
+        {
+            unsigned int id = 0;
+            std::string name{};
+            std::string type{}; // type or class in Tiled
+            std::string layer{}; // name of its object layer
+            rl::tmx_obj_type obj_type = rl::OT_NONE;
+            // top left and size. Polygons and polylines use the bounds of their points.
+            // Rotation is not applied.
+            Rect rect{};
+            float rotation = 0.0f;
+            unsigned int gid = 0; // OT_TILE, without flip bits
+            std::vector<math::Vector2> points{}; // OT_POLYGON and OT_POLYLINE, map position
+            std::unordered_map<std::string, Property> properties{};
+        };
+
+        // All objects of all object layers of a map, read once into a flat table. Indexed
+        // by name, type and id, and by position in a SpatialGrid for trigger checks.
+        class ObjectTable
+        {
+        public:
+
+            // ObjectTable cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            explicit ObjectTable(const rl::tmx_map *map, float cell_size = 64.0f);
+
+            // Indexes in `objects` of the objects named `name`
+            [[nodiscard]] const std::vector<unsigned int> &
+            FindByName(const std::string &name) const;
+            // Indexes in `objects` of the objects with type (class) `type`
+            [[nodiscard]] const std::vector<unsigned int> &
+            FindByType(const std::string &type) const;
+            // nullptr if there is no object `id`
+            [[nodiscard]] const Object *GetById(unsigned int id) const;
+            // Indexes in `objects` of the objects whose rect overlaps or touches `area`
+            [[nodiscard]] std::vector<unsigned int> Query(const Rect &area) const;
+
+            std::vector<Object> objects{};
+
+        private:
+
+            void AddLayers(const rl::tmx_layer *layer);
+
+            std::unordered_map<std::string, std::vector<unsigned int>> names{};
+            std::unordered_map<std::string, std::vector<unsigned int>> types{};
+            std::unordered_map<unsigned int, unsigned int> ids{};
+            collision::SpatialGrid grid;
+        };
+    } // namespace tmx
+#endif // WITH_TMX
+
     namespace font
     {
+        class TextLayout;
+
         class Font
         {
         public:
@@ -782,24 +1534,218 @@ namespace rg
             explicit Font(float font_size = 1);
             // Load font from file
             Font(const char *file, float font_size);
+            // Load font from file as a signed distance field atlas of `base_size` glyphs. It
+            // is drawn sharp at any size with a shader, one Font serves all text sizes.
+            // If not `sdf`, same as Font(file, font_size).
+            Font(const char *file, float font_size, bool sdf, int base_size = 64);
             // Raylib Font
             Font(rl::Font font, float font_size);
             ~Font();
             // Creates a Text surface from this Font. Make sure to delete it.
             // If passed padding_width or padding_height, surface dimensions will be added
             // (textsize + (width,height))
+            // If the cache is enabled (SetCacheBudget), the same surface is returned for the
+            // same arguments, don't draw into it.
             Surface_Ptr
             render(const char *text, rl::Color color, float spacing = 1, rl::Color bg = rl::BLANK,
                    float padding_width = 0, float padding_height = 0) const;
+            // Draws text into `surface` with its top left at `position`. Glyphs are drawn
+            // from the font atlas, nothing is allocated. Prefer this for text that changes
+            // every frame. `text_size` 0 uses font_size.
+            void draw(
+                    const Surface_Ptr &surface, const char *text, math::Vector2 position,
+                    rl::Color color, float spacing = 1, float text_size = 0) const;
             math::Vector2 size(const char *text) const;
+            [[nodiscard]] bool IsSDF() const;
+            // Index of `codepoint` in font glyphs. Memoized, raylib searches all glyphs.
+            [[nodiscard]] int GlyphIndex(int codepoint) const;
+            // Sum of the glyph advances of `word` at font base size, without spacing, and its
+            // number of glyphs. Memoized.
+            [[nodiscard]] std::pair<float, int> WordAdvance(const std::string &word) const;
+
+            struct CacheStats
+            {
+                unsigned int hits = 0;
+                unsigned int misses = 0;
+                unsigned int evictions = 0;
+                unsigned int entries = 0;
+                size_t bytes = 0; // VRAM used by cached surfaces
+            };
+
+            // Keeps up to `bytes` of VRAM of rendered surfaces, least recently used ones are
+            // dropped first. 0 disables the cache (default).
+            void SetCacheBudget(size_t bytes);
+            [[nodiscard]] CacheStats GetCacheStats() const;
+            // Drops all cached surfaces
+            void ClearCache();
 
             rl::Font font;
             float font_size;
+
+        private:
+
+            struct RenderKey
+            {
+                std::string text;
+                // font_size is public and can change between renders
+                float font_size;
+                unsigned int color;
+                unsigned int bg;
+                float spacing;
+                float padding_width;
+                float padding_height;
+
+                bool operator==(const RenderKey &other) const;
+            };
+            struct RenderKeyHash
+            {
+                size_t operator()(const RenderKey &key) const;
+            };
+            struct CacheEntry
+            {
+                RenderKey key;
+                Surface_Ptr surface;
+                size_t bytes;
+            };
+
+            friend class TextLayout;
+
+            // drops least recently used surfaces until bytes fit the budget
+            void TrimCache() const;
+            // Sets the SDF shader for SDF fonts, call EndDraw after drawing
+            void BeginDraw() const;
+            void EndDraw() const;
+
+            bool sdf = false;
+            mutable std::unordered_map<int, int> glyph_indexes{};
+            mutable std::unordered_map<std::string, std::pair<float, int>> word_advances{};
+
+            size_t cache_budget = 0;
+            // most recently used first
+            mutable std::list<CacheEntry> cache_order{};
+            mutable std::unordered_map<RenderKey, std::list<CacheEntry>::iterator, RenderKeyHash>
+                    cache{};
+            mutable CacheStats cache_stats{};
+        };
+
+        enum TextAlign
+        {
+            ALIGN_LEFT = 0,
+            ALIGN_CENTER,
+            ALIGN_RIGHT,
+        };
+
+        // Text laid out once: wrapped at `max_width` (0 doesn't wrap), aligned and kept as
+        // glyph quads. Draw only draws the quads, nothing is measured again.
+        // `font` must outlive the layout.
+        class TextLayout
+        {
+        public:
+
+            // TextLayout cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            struct Glyph
+            {
+                Rect source; // in font atlas
+                Rect dest; // from the layout top left
+            };
+            struct Line
+            {
+                unsigned int first_glyph;
+                unsigned int glyph_count;
+                float width;
+            };
+
+            // `text_size` 0 uses font size. Lines are `text_size + line_spacing` apart.
+            TextLayout(
+                    const Font &font, const char *text, float max_width = 0,
+                    TextAlign align = ALIGN_LEFT, float spacing = 1, float line_spacing = 2,
+                    float text_size = 0);
+
+            // Draws the glyphs into `surface` with the layout top left at `position`
+            void Draw(const Surface_Ptr &surface, math::Vector2 position, rl::Color color) const;
+            [[nodiscard]] math::Vector2 GetSize() const;
+
+            std::vector<Glyph> glyphs{};
+            std::vector<Line> lines{};
+
+        private:
+
+            // Adds the glyphs of `word` at `pen` to `pending`, moves `pen` after them
+            void AddWord(const std::string &word, float *pen, std::vector<Glyph> *pending);
+            // Moves `pending` glyphs into a new line
+            void EndLine(float pen, std::vector<Glyph> *pending);
+
+            const Font *font;
+            float scale;
+            float spacing;
+            float line_height;
+            math::Vector2 size{};
         };
     } // namespace font
 
     namespace mixer
     {
+        class Sound;
+
+        // One voice of the mixer pool (like pygame's mixer.Channel). Voices are aliases of a
+        // Sound, they share its samples, so one Sound can play on many channels at once.
+        class Channel
+        {
+        public:
+
+            // Channel cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            // id -1 is no channel, all calls do nothing
+            explicit Channel(int id = -1);
+
+            // Plays `sound` from the start, replacing what the channel was playing. Plays
+            // `loops` more times after the first, forever if -1. Higher `priority` voices are
+            // kept when the pool is full.
+            void play(const Sound &sound, int loops = 0, int priority = 0) const;
+            void stop() const;
+            void pause() const;
+            void unpause() const;
+            // Channel volume, multiplied by the Sound volume. Reset to 1 by play().
+            void set_volume(float value) const;
+            [[nodiscard]] float get_volume() const;
+            // Makes the channel positional, its volume fades with the distance to the
+            // listener and it pans to the listener side. Reset by play().
+            void set_position(math::Vector2 position) const;
+            [[nodiscard]] math::Vector2 get_position() const;
+            [[nodiscard]] bool get_busy() const;
+            // Sound playing in the channel, nullptr if idle
+            [[nodiscard]] const Sound *get_sound() const;
+            [[nodiscard]] int GetId() const;
+
+        private:
+
+            int id;
+        };
+
+        // Sets the number of voices in the pool (8 by default), removed voices are stopped
+        void set_num_channels(int count);
+        [[nodiscard]] int get_num_channels();
+        // An idle channel. If all are busy and `force`, the voice with lowest priority, not
+        // above `priority`, oldest first, is stopped and returned. Channel(-1) if none.
+        [[nodiscard]] Channel find_channel(bool force = false, int priority = 0);
+        // Stops all channels
+        void stop();
+        void pause();
+        void unpause();
+        // Position that hears positional channels
+        void set_listener(math::Vector2 position);
+        [[nodiscard]] math::Vector2 get_listener();
+        // Positional channels play at full volume up to `min_distance` from the listener and
+        // fade linearly until silent at `max_distance`. Pan is full left or right when the
+        // horizontal distance reaches `max_distance`.
+        void set_distance(float min_distance, float max_distance);
+        // Repeats looping channels and updates positional ones, called by display::Update.
+        // Cost is fixed by the number of channels, not by how many times sounds are played.
+        void Update();
+
         class Sound : public std::enable_shared_from_this<Sound>
         {
         public:
@@ -811,17 +1757,68 @@ namespace rg
             explicit Sound(const char *file, bool isMusic = false);
             ~Sound();
 
-            void Play() const;
+            // Sounds play in a free channel of the pool, or steal one with lower or same
+            // `priority`. Returns the channel, Channel(-1) for musics or if all voices have
+            // higher priority.
+            Channel Play(int loops = 0, int priority = 0) const;
+            // Stops the music or all channels playing the sound
             void Stop() const;
             void SetVolume(float value) const;
+            [[nodiscard]] float GetVolume() const;
             [[nodiscard]] const char *GetFilename() const;
 
             std::shared_ptr<void> audio = nullptr;
 
         private:
 
+            friend class Channel;
+            friend class SoundBank;
+
+            static void InitAudio();
+            // Decodes `compressed` into audio, for sounds loaded lazily by SoundBank. False if
+            // the sound has no samples (music, missing file or decoding failed).
+            [[nodiscard]] bool Decode() const;
+
             bool isMusic{};
-            const char *file = nullptr;
+            std::string file{};
+            mutable float volume = 1.0f;
+            mutable std::vector<unsigned char> compressed{}; // file data, until first play
+        };
+
+        // Owns all sounds (wav, ogg, mp3, flac, qoa) in a folder, by file name without
+        // extension. Files are decoded in parallel, but compressed files bigger than
+        // `lazy_size` bytes are kept compressed and decoded when first played.
+        class SoundBank
+        {
+        public:
+
+            // SoundBank cannot be allocated in Heap
+            void *operator new(size_t) = delete;
+
+            explicit SoundBank(const char *path, int lazy_size = 1024 * 1024);
+            SoundBank(const SoundBank &) = delete;
+            SoundBank &operator=(const SoundBank &) = delete;
+
+            // Sound of file `name`, nullptr if there is no such file
+            [[nodiscard]] const Sound *Get(const std::string &name) const;
+            // Adds `file`, or returns the sound already loaded from the same path.
+            // nullptr if it can't be loaded or another file has the same name.
+            const Sound *Load(const char *file);
+            [[nodiscard]] bool has(const std::string &name) const;
+            // If false, the sound is still compressed
+            [[nodiscard]] bool IsDecoded(const std::string &name) const;
+            [[nodiscard]] std::vector<std::string> Names() const;
+            [[nodiscard]] unsigned int size() const;
+
+        private:
+
+            // Loads `files` in parallel, adding them as `names`
+            void LoadFiles(
+                    const std::vector<std::string> &files, const std::vector<std::string> &names);
+
+            int lazy_size;
+            std::map<std::string, Sound> sounds{}; // name -> sound
+            std::map<std::string, std::string> paths{}; // normalized path -> name
         };
     } // namespace mixer
 
@@ -78,6 +78,10 @@ rl::Image rg::LoadImageFromTextureSafe(const rl::Texture &texture)
 void rg::UnloadTextureSafe(const rl::Texture2D &texture)
 {
     EndTextureModeSafe();
+    if (texture.id)
+    {
+        mask::ClearCache(texture.id); // id can be reused by a new texture
+    }
     UnloadTexture(texture);
 }
 
@@ -90,6 +94,10 @@ rl::RenderTexture2D rg::LoadRenderTextureSafe(const int width, const int height)
 void rg::UnloadRenderTextureSafe(const rl::RenderTexture2D &render)
 {
     EndTextureModeSafe();
+    if (render.texture.id)
+    {
+        mask::ClearCache(render.texture.id); // id can be reused by a new texture
+    }
     UnloadRenderTexture(render);
 }
 
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// Bit helpers for the 64 bit words of masks
+
+inline unsigned int PopCount(const uint64_t word)
+{
+#if defined(_MSC_VER)
+    return (unsigned int) __popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// index of the lowest set bit, `word` must not be 0
+inline unsigned int FirstBit(const uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
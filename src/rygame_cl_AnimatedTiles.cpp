@@ -0,0 +1,141 @@
+#include "rygame.hpp"
+#include <cmath>
+
+
+#ifdef WITH_TMX
+rg::tmx::AnimatedTiles::AnimatedTiles(const rl::tmx_map *map, const rl::tmx_layer *layer)
+{
+    if (layer->type != rl::L_LAYER)
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat("AnimatedTiles layer %s has no tiles", layer->name));
+        return;
+    }
+    // animation index of each animated gid
+    std::unordered_map<unsigned int, unsigned int> gid_animation;
+    for (unsigned int y = 0; y < map->height; y++)
+    {
+        for (unsigned int x = 0; x < map->width; x++)
+        {
+            const unsigned int baseGid = layer->content.gids[y * map->width + x];
+            const unsigned int gid = baseGid & TMX_FLIP_BITS_REMOVAL;
+            const rl::tmx_tile *tile = map->tiles[gid];
+            if (!tile || !tile->animation || !tile->animation_len)
+            {
+                continue;
+            }
+            auto found = gid_animation.find(gid);
+            if (found == gid_animation.end())
+            {
+                Animation animation;
+                // frames are ids local to the tileset
+                const unsigned int first_gid = gid - tile->id;
+                for (unsigned int i = 0; i < tile->animation_len; ++i)
+                {
+                    const unsigned int frame_gid = first_gid + tile->animation[i].tile_id;
+                    const rl::tmx_tile *frame_tile =
+                            frame_gid < map->tilecount ? map->tiles[frame_gid] : nullptr;
+                    if (!frame_tile)
+                    {
+                        continue;
+                    }
+                    Rect atlas_rect{};
+                    animation.textures.push_back(GetTMXTileTexture(frame_tile, &atlas_rect));
+                    animation.atlas_rects.push_back(atlas_rect);
+                    animation.tile_size.x = std::max(animation.tile_size.x, atlas_rect.width);
+                    animation.tile_size.y =
+                            std::max(animation.tile_size.y, std::fabs(atlas_rect.height));
+                    animation.durations.push_back((float) tile->animation[i].duration / 1000.0f);
+                    animation.cycle += animation.durations.back();
+                }
+                if (animation.textures.empty())
+                {
+                    continue;
+                }
+                found = gid_animation.emplace(gid, animations.size()).first;
+                animations.push_back(animation);
+            }
+            // same placement as GetTMXTiles
+            const rl::tmx_tileset *ts = tile->tileset;
+            animations[found->second].positions.push_back(
+                    {(float) x * ts->tile_width, (float) y * ts->tile_height});
+        }
+    }
+}
+
+void rg::tmx::AnimatedTiles::Update(const float deltaTime)
+{
+    for (auto &animation: animations)
+    {
+        animation.time += deltaTime;
+        // any whole cycle ends where it started, skip them
+        if (animation.cycle > 0.0f && animation.time >= animation.cycle)
+        {
+            animation.time = std::fmod(animation.time, animation.cycle);
+        }
+        unsigned int frame = animation.frame;
+        for (size_t i = 0; i < animation.durations.size(); ++i)
+        {
+            if (animation.time < animation.durations[frame])
+            {
+                break;
+            }
+            animation.time -= animation.durations[frame];
+            frame = frame + 1 == animation.durations.size() ? 0 : frame + 1;
+        }
+        animation.frame = frame;
+    }
+}
+
+void rg::tmx::AnimatedTiles::Draw(
+        const Surface_Ptr &surface, const Rect &area, const math::Vector2 offset) const
+{
+    if (animations.empty())
+    {
+        return;
+    }
+    surface->ToggleRender();
+    for (const auto &animation: animations)
+    {
+        const rl::Texture2D *texture = animation.textures[animation.frame];
+        if (!texture)
+        {
+            continue;
+        }
+        const Rect &atlas_rect = animation.atlas_rects[animation.frame];
+        // same source as Surface::Blit
+        const rl::Rectangle source = {
+                atlas_rect.x, atlas_rect.y, atlas_rect.width, -atlas_rect.height};
+        // positions are sorted by y, only the rows crossing `area` are visited
+        const auto first = std::lower_bound(
+                animation.positions.begin(), animation.positions.end(),
+                area.y - animation.tile_size.y,
+                [](const math::Vector2 &position, const float y) { return position.y <= y; });
+        for (auto it = first; it != animation.positions.end(); ++it)
+        {
+            const math::Vector2 &position = *it;
+            if (position.y >= area.y + area.height)
+            {
+                break;
+            }
+            if (position.x >= area.x + area.width ||
+                position.x + animation.tile_size.x <= area.x)
+            {
+                continue;
+            }
+            DrawTextureRec(*texture, source, (position + offset).vector2, rl::WHITE);
+        }
+    }
+}
+
+unsigned int rg::tmx::AnimatedTiles::size() const
+{
+    unsigned int result = 0;
+    for (const auto &animation: animations)
+    {
+        result += animation.positions.size();
+    }
+    return result;
+}
+#endif // WITH_TMX
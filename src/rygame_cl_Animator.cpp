@@ -0,0 +1,223 @@
+#include "rygame.hpp"
+#include <cmath>
+
+
+int rg::animation::Animator::AddClip(const Clip_Ptr &clip)
+{
+    clips.push_back(clip);
+    clip_cycles.push_back(clip->CycleDuration());
+    return (int) clips.size() - 1;
+}
+
+unsigned int rg::animation::Animator::Add(const int clip_id, const float speed)
+{
+    unsigned int instance;
+    if (!free_ids.empty())
+    {
+        instance = free_ids.back();
+        free_ids.pop_back();
+    }
+    else
+    {
+        instance = sparse.size();
+        sparse.push_back(0);
+    }
+    sparse[instance] = dense_ids.size();
+    dense_ids.push_back(instance);
+
+    // stays finished (not updated) if clip_id is invalid
+    clip_ids.push_back(-1);
+    steps.push_back(0);
+    directions.push_back(1);
+    times.push_back(0.0f);
+    speeds.push_back(speed > 0.0f ? speed : 0.0f);
+    current_frames.push_back(0);
+    finished.push_back(true);
+
+    Play(instance, clip_id, true);
+    return instance;
+}
+
+void rg::animation::Animator::Remove(const unsigned int instance)
+{
+    if (!IsValid(instance))
+    {
+        return;
+    }
+    // swap with the last instance to keep arrays contiguous
+    const unsigned int pos = sparse[instance];
+    const unsigned int last = dense_ids.size() - 1;
+    if (pos != last)
+    {
+        clip_ids[pos] = clip_ids[last];
+        steps[pos] = steps[last];
+        directions[pos] = directions[last];
+        times[pos] = times[last];
+        speeds[pos] = speeds[last];
+        current_frames[pos] = current_frames[last];
+        finished[pos] = finished[last];
+        dense_ids[pos] = dense_ids[last];
+        sparse[dense_ids[pos]] = pos;
+    }
+    clip_ids.pop_back();
+    steps.pop_back();
+    directions.pop_back();
+    times.pop_back();
+    speeds.pop_back();
+    current_frames.pop_back();
+    finished.pop_back();
+    dense_ids.pop_back();
+
+    free_ids.push_back(instance);
+}
+
+void rg::animation::Animator::Clear()
+{
+    clip_ids.clear();
+    steps.clear();
+    directions.clear();
+    times.clear();
+    speeds.clear();
+    current_frames.clear();
+    finished.clear();
+    dense_ids.clear();
+    sparse.clear();
+    free_ids.clear();
+}
+
+void rg::animation::Animator::Play(
+        const unsigned int instance, const int clip_id, const bool restart)
+{
+    if (!IsValid(instance))
+    {
+        return;
+    }
+    if (clip_id < 0 || clip_id >= (int) clips.size())
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("Animator::Play invalid clip %d", clip_id));
+        return;
+    }
+    const unsigned int pos = sparse[instance];
+    if (clip_ids[pos] == clip_id && !restart)
+    {
+        return;
+    }
+    clip_ids[pos] = clip_id;
+    steps[pos] = 0;
+    directions[pos] = 1;
+    times[pos] = 0.0f;
+    finished[pos] = false;
+    const Clip &clip = *clips[clip_id];
+    current_frames[pos] = clip.frame_indexes.empty() ? 0 : clip.frame_indexes[0];
+}
+
+void rg::animation::Animator::SetSpeed(const unsigned int instance, const float speed)
+{
+    if (!IsValid(instance))
+    {
+        return;
+    }
+    speeds[sparse[instance]] = speed > 0.0f ? speed : 0.0f;
+}
+
+void rg::animation::Animator::Update(const float deltaTime)
+{
+    const size_t count = dense_ids.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (finished[i] || speeds[i] == 0.0f)
+        {
+            continue;
+        }
+        const Clip &clip = *clips[clip_ids[i]];
+        const int n = (int) clip.frame_indexes.size();
+        if (n < 2)
+        {
+            continue;
+        }
+        const float cycle = clip_cycles[clip_ids[i]];
+        if (clip.mode != ONCE && cycle <= 0.0f)
+        {
+            continue;
+        }
+
+        float t = times[i] + deltaTime * speeds[i];
+        // any whole cycle ends where it started, skip them
+        if (cycle > 0.0f && t >= cycle)
+        {
+            t = std::fmod(t, cycle);
+        }
+        int step = steps[i];
+        signed char direction = directions[i];
+        const float *durations = clip.durations.data();
+        while (t >= durations[step])
+        {
+            if (clip.mode == ONCE && step == n - 1)
+            {
+                finished[i] = true;
+                t = 0.0f;
+                break;
+            }
+            t -= durations[step];
+            switch (clip.mode)
+            {
+                case ONCE:
+                    ++step;
+                    break;
+                case LOOP:
+                    step = step + 1 == n ? 0 : step + 1;
+                    break;
+                case PINGPONG:
+                    if (step + direction < 0 || step + direction >= n)
+                    {
+                        direction = (signed char) -direction;
+                    }
+                    step += direction;
+                    break;
+            }
+        }
+        times[i] = t;
+        steps[i] = step;
+        directions[i] = direction;
+        current_frames[i] = clip.frame_indexes[step];
+    }
+}
+
+int rg::animation::Animator::GetFrame(const unsigned int instance) const
+{
+    if (!IsValid(instance))
+    {
+        return 0;
+    }
+    return current_frames[sparse[instance]];
+}
+
+bool rg::animation::Animator::IsFinished(const unsigned int instance) const
+{
+    if (!IsValid(instance))
+    {
+        return true;
+    }
+    return finished[sparse[instance]];
+}
+
+void rg::animation::Animator::Apply(const unsigned int instance, const Frames_Ptr &frames) const
+{
+    frames->SetAtlas(GetFrame(instance));
+}
+
+unsigned int rg::animation::Animator::size() const
+{
+    return dense_ids.size();
+}
+
+bool rg::animation::Animator::IsValid(const unsigned int instance) const
+{
+    if (instance < sparse.size() && sparse[instance] < dense_ids.size() &&
+        dense_ids[sparse[instance]] == instance)
+    {
+        return true;
+    }
+    TraceLog(rl::LOG_WARNING, rl::TextFormat("Animator invalid instance %d", instance));
+    return false;
+}
@@ -0,0 +1,149 @@
+#include "rygame.hpp"
+#include "rygame_cl_Rygame.hpp"
+
+
+extern Rygame rygame;
+
+static MixerVoice *GetVoice(const int id)
+{
+    if (id < 0 || id >= (int) rygame.voices.size())
+    {
+        return nullptr;
+    }
+    return &rygame.voices[id];
+}
+
+rg::mixer::Channel::Channel(const int id) : id(id)
+{}
+
+void rg::mixer::Channel::play(const Sound &sound, const int loops, const int priority) const
+{
+    MixerVoice *voice = GetVoice(id);
+    if (!voice || !sound.audio)
+    {
+        return;
+    }
+    if (sound.isMusic)
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat("Channel can't play music %s", sound.GetFilename()));
+        return;
+    }
+    if (!sound.Decode())
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat("Channel can't play sound %s", sound.GetFilename()));
+        return;
+    }
+    if (voice->sound != &sound)
+    {
+        voice->Release();
+        voice->alias = rl::LoadSoundAlias(*(rl::Sound *) sound.audio.get());
+        voice->sound = &sound;
+    }
+    voice->loops = loops;
+    voice->priority = priority;
+    voice->volume = 1.0f;
+    voice->order = ++rygame.voice_order;
+    voice->paused = false;
+    voice->positional = false;
+    voice->gain = 1.0f;
+    voice->pan = 0.5f;
+    SetSoundVolume(voice->alias, sound.volume);
+    SetSoundPan(voice->alias, voice->pan);
+    // PlaySound restarts the alias if it is still playing
+    PlaySound(voice->alias);
+}
+
+void rg::mixer::Channel::stop() const
+{
+    MixerVoice *voice = GetVoice(id);
+    if (voice && voice->sound)
+    {
+        StopSound(voice->alias);
+        voice->loops = 0;
+        voice->paused = false;
+    }
+}
+
+void rg::mixer::Channel::pause() const
+{
+    MixerVoice *voice = GetVoice(id);
+    // also mark voices whose alias is between loops, so mixer::Update does not restart them
+    if (voice && voice->sound)
+    {
+        if (IsSoundPlaying(voice->alias))
+        {
+            PauseSound(voice->alias);
+        }
+        voice->paused = true;
+    }
+}
+
+void rg::mixer::Channel::unpause() const
+{
+    MixerVoice *voice = GetVoice(id);
+    if (voice && voice->paused)
+    {
+        ResumeSound(voice->alias);
+        voice->paused = false;
+    }
+}
+
+void rg::mixer::Channel::set_volume(const float value) const
+{
+    MixerVoice *voice = GetVoice(id);
+    if (!voice)
+    {
+        return;
+    }
+    voice->volume = value;
+    if (voice->sound)
+    {
+        SetSoundVolume(voice->alias, value * voice->gain * voice->sound->volume);
+    }
+}
+
+float rg::mixer::Channel::get_volume() const
+{
+    const MixerVoice *voice = GetVoice(id);
+    return voice ? voice->volume : 0.0f;
+}
+
+void rg::mixer::Channel::set_position(const math::Vector2 position) const
+{
+    MixerVoice *voice = GetVoice(id);
+    if (!voice || !voice->sound)
+    {
+        return;
+    }
+    voice->positional = true;
+    voice->position = position;
+    SpatializeVoice(*voice);
+}
+
+rg::math::Vector2 rg::mixer::Channel::get_position() const
+{
+    const MixerVoice *voice = GetVoice(id);
+    return voice ? voice->position : math::Vector2{};
+}
+
+bool rg::mixer::Channel::get_busy() const
+{
+    const MixerVoice *voice = GetVoice(id);
+    // a looping voice stays busy while its alias waits for mixer::Update to restart it
+    return voice && voice->sound &&
+           (voice->paused || voice->loops != 0 || IsSoundPlaying(voice->alias));
+}
+
+const rg::mixer::Sound *rg::mixer::Channel::get_sound() const
+{
+    return get_busy() ? rygame.voices[id].sound : nullptr;
+}
+
+int rg::mixer::Channel::GetId() const
+{
+    return id;
+}
@@ -0,0 +1,155 @@
+#include "rygame.hpp"
+#include <cmath>
+
+
+#ifdef WITH_TMX
+rg::tmx::ChunkedLayer::ChunkedLayer(
+        const rl::tmx_map *map, const rl::tmx_layer *layer, const int chunk_size,
+        const int margin, const bool skip_animated)
+    : map(map), layer(layer), chunk_size(chunk_size > 0 ? chunk_size : 512),
+      margin(margin > 0 ? margin : 0), skip_animated(skip_animated)
+{
+    const int width = (int) (map->width * map->tile_width);
+    const int height = (int) (map->height * map->tile_height);
+    cols = (width + this->chunk_size - 1) / this->chunk_size;
+    rows = (height + this->chunk_size - 1) / this->chunk_size;
+    if (layer->type != rl::L_LAYER)
+    {
+        TraceLog(
+                rl::LOG_WARNING, rl::TextFormat("ChunkedLayer layer %s has no tiles", layer->name));
+        cols = rows = 0;
+    }
+}
+
+void rg::tmx::ChunkedLayer::Update(const Rect &camera)
+{
+    int cx0, cy0, cx1, cy1;
+    if (!ChunkRange(camera, &cx0, &cy0, &cx1, &cy1))
+    {
+        chunks.clear();
+        return;
+    }
+    // keeps one extra chunk before unloading, so moving back and forth over a chunk border
+    // doesn't bake the same chunks every frame
+    const int keep = margin + 1;
+    for (auto it = chunks.begin(); it != chunks.end();)
+    {
+        const int cx = (int) (it->first >> 32);
+        const int cy = (int) (int32_t) (it->first & 0xFFFFFFFF);
+        if (cx < cx0 - keep || cx > cx1 + keep || cy < cy0 - keep || cy > cy1 + keep)
+        {
+            it = chunks.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (int cy = cy0 - margin; cy <= cy1 + margin; ++cy)
+    {
+        for (int cx = cx0 - margin; cx <= cx1 + margin; ++cx)
+        {
+            GetChunk(cx, cy);
+        }
+    }
+}
+
+void rg::tmx::ChunkedLayer::Draw(const Surface_Ptr &surface, const Rect &camera) const
+{
+    int cx0, cy0, cx1, cy1;
+    if (!ChunkRange(camera, &cx0, &cy0, &cx1, &cy1))
+    {
+        return;
+    }
+    for (int cy = cy0; cy <= cy1; ++cy)
+    {
+        for (int cx = cx0; cx <= cx1; ++cx)
+        {
+            const auto it = chunks.find(Key(cx, cy));
+            if (it == chunks.end())
+            {
+                continue;
+            }
+            const math::Vector2 position = {
+                    (float) (cx * chunk_size) - camera.x, (float) (cy * chunk_size) - camera.y};
+            surface->Blit(it->second, position);
+        }
+    }
+}
+
+rg::Surface_Ptr rg::tmx::ChunkedLayer::GetChunk(const int cx, const int cy)
+{
+    if (cx < 0 || cy < 0 || cx >= cols || cy >= rows)
+    {
+        return nullptr;
+    }
+    Surface_Ptr &chunk = chunks[Key(cx, cy)];
+    if (!chunk)
+    {
+        chunk = Bake(cx, cy);
+    }
+    return chunk;
+}
+
+unsigned int rg::tmx::ChunkedLayer::size() const
+{
+    return chunks.size();
+}
+
+rg::Surface_Ptr rg::tmx::ChunkedLayer::Bake(const int cx, const int cy) const
+{
+    const int left = cx * chunk_size;
+    const int top = cy * chunk_size;
+    const int width = std::min(chunk_size, (int) (map->width * map->tile_width) - left);
+    const int height = std::min(chunk_size, (int) (map->height * map->tile_height) - top);
+    const auto surface = std::make_shared<Surface>(width, height);
+    surface->Fill(rl::BLANK);
+
+    // one extra tile before the chunk, tiles bigger than the map grid can overflow into it
+    const int x0 = std::max(left / (int) map->tile_width - 1, 0);
+    const int y0 = std::max(top / (int) map->tile_height - 1, 0);
+    const int x1 = std::min((left + width - 1) / (int) map->tile_width, (int) map->width - 1);
+    const int y1 = std::min((top + height - 1) / (int) map->tile_height, (int) map->height - 1);
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            const unsigned int baseGid = layer->content.gids[y * map->width + x];
+            const unsigned int gid = baseGid & TMX_FLIP_BITS_REMOVAL;
+            if (!map->tiles[gid] || (skip_animated && map->tiles[gid]->animation))
+            {
+                continue;
+            }
+            // same placement as GetTMXTiles
+            const rl::tmx_tileset *ts = map->tiles[gid]->tileset;
+            Rect atlas_rect{};
+            const auto *texture = GetTMXTileTexture(map->tiles[gid], &atlas_rect);
+            if (!texture)
+            {
+                continue;
+            }
+            const math::Vector2 pos = {
+                    (float) x * ts->tile_width - (float) left,
+                    (float) y * ts->tile_height - (float) top};
+            surface->Blit(*texture, pos, atlas_rect);
+        }
+    }
+    return surface;
+}
+
+bool rg::tmx::ChunkedLayer::ChunkRange(
+        const Rect &area, int *cx0, int *cy0, int *cx1, int *cy1) const
+{
+    const float size = (float) chunk_size;
+    *cx0 = (int) std::floor(std::max(area.x / size, 0.0f));
+    *cy0 = (int) std::floor(std::max(area.y / size, 0.0f));
+    *cx1 = (int) std::ceil(std::min((area.x + area.width) / size, (float) cols)) - 1;
+    *cy1 = (int) std::ceil(std::min((area.y + area.height) / size, (float) rows)) - 1;
+    return *cx0 <= *cx1 && *cy0 <= *cy1;
+}
+
+int64_t rg::tmx::ChunkedLayer::Key(const int cx, const int cy)
+{
+    return (int64_t) cx << 32 | (uint32_t) cy;
+}
+#endif // WITH_TMX
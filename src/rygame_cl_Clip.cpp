@@ -0,0 +1,52 @@
+#include "rygame.hpp"
+
+
+rg::animation::Clip::Clip(
+        const int first_frame, const int last_frame, const float frame_duration,
+        const PlayMode mode)
+    : mode(mode)
+{
+    const int step = first_frame <= last_frame ? 1 : -1;
+    for (int i = first_frame; i != last_frame + step; i += step)
+    {
+        frame_indexes.push_back(i);
+        durations.push_back(frame_duration);
+    }
+}
+
+rg::animation::Clip::Clip(
+        const std::vector<int> &frame_indexes, const std::vector<float> &durations,
+        const PlayMode mode)
+    : frame_indexes(frame_indexes), durations(durations), mode(mode)
+{
+    if (this->durations.size() != this->frame_indexes.size())
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat(
+                        "Clip has %d frames and %d durations", this->frame_indexes.size(),
+                        this->durations.size()));
+        const float last = this->durations.empty() ? 0.0f : this->durations.back();
+        this->durations.resize(this->frame_indexes.size(), last);
+    }
+}
+
+float rg::animation::Clip::CycleDuration() const
+{
+    const size_t n = frame_indexes.size();
+    if (n < 2 || mode == ONCE)
+    {
+        return 0.0f;
+    }
+    float total = 0.0f;
+    for (const float duration: durations)
+    {
+        total += duration;
+    }
+    if (mode == PINGPONG)
+    {
+        // first and last frames are shown once per cycle, the ones in between twice
+        total = 2.0f * total - durations.front() - durations.back();
+    }
+    return total;
+}
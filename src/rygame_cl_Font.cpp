@@ -1,4 +1,38 @@
 #include "rygame.hpp"
+#include "rygame_cl_Rygame.hpp"
+
+extern Rygame rygame;
+
+// Smooths the glyph edges from the distance stored in the atlas alpha
+static const char *sdf_fragment_shader =
+#if defined(PLATFORM_WEB) || defined(__EMSCRIPTEN__)
+        "#version 100\n"
+        "#extension GL_OES_standard_derivatives : enable\n"
+        "precision mediump float;\n"
+        "varying vec2 fragTexCoord;\n"
+        "varying vec4 fragColor;\n"
+        "uniform sampler2D texture0;\n"
+        "void main()\n"
+        "{\n"
+        "    float distance = texture2D(texture0, fragTexCoord).a - 0.5;\n"
+        "    float change = length(vec2(dFdx(distance), dFdy(distance)));\n"
+        "    float alpha = smoothstep(-change, change, distance);\n"
+        "    gl_FragColor = vec4(fragColor.rgb, fragColor.a * alpha);\n"
+        "}\n";
+#else
+        "#version 330\n"
+        "in vec2 fragTexCoord;\n"
+        "in vec4 fragColor;\n"
+        "uniform sampler2D texture0;\n"
+        "out vec4 finalColor;\n"
+        "void main()\n"
+        "{\n"
+        "    float distance = texture(texture0, fragTexCoord).a - 0.5;\n"
+        "    float change = length(vec2(dFdx(distance), dFdy(distance)));\n"
+        "    float alpha = smoothstep(-change, change, distance);\n"
+        "    finalColor = vec4(fragColor.rgb, fragColor.a * alpha);\n"
+        "}\n";
+#endif
 
 
 rg::font::Font::Font(const float font_size) : font(rl::GetFontDefault()), font_size(font_size)
@@ -8,6 +42,39 @@ rg::font::Font::Font(const char *file, const float font_size)
     : font(rl::LoadFontEx(file, font_size, nullptr, 0)), font_size(font_size)
 {}
 
+rg::font::Font::Font(
+        const char *file, const float font_size, const bool sdf, const int base_size)
+    : font_size(font_size), sdf(sdf)
+{
+    if (!sdf)
+    {
+        font = rl::LoadFontEx(file, font_size, nullptr, 0);
+        return;
+    }
+    // same as LoadFontEx, but with glyphs as distance fields
+    int dataSize = 0;
+    unsigned char *fileData = rl::LoadFileData(file, &dataSize);
+    font = {};
+    font.baseSize = base_size;
+    font.glyphCount = 95;
+    font.glyphPadding = 0;
+    font.glyphs = rl::LoadFontData(fileData, dataSize, base_size, nullptr, 0, rl::FONT_SDF);
+    rl::UnloadFileData(fileData);
+    if (!font.glyphs)
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("Could not load SDF font %s", file));
+        this->sdf = false;
+        font = rl::GetFontDefault();
+        return;
+    }
+    const rl::Image atlas =
+            rl::GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, base_size, 0, 1);
+    font.texture = LoadTextureFromImageSafe(atlas);
+    UnloadImage(atlas);
+    // the shader needs the distance between texels
+    SetTextureFilter(font.texture, rl::TEXTURE_FILTER_BILINEAR);
+}
+
 // rl:Font is trivial copiable
 // ReSharper disable once CppPassValueParameterByConstReference
 rg::font::Font::Font(rl::Font font, const float font_size) : font(font), font_size(font_size)
@@ -23,24 +90,176 @@ rg::Surface_Ptr rg::font::Font::render(
         const float padding_width, const float padding_height) const
 {
     TraceLog(rl::LOG_TRACE, rl::TextFormat("Font::render %s", text));
-    const rl::Image imageText = ImageTextEx(font, text, font_size, spacing, color);
-    const rl::Texture texture = LoadTextureFromImageSafe(imageText);
+    RenderKey key{};
+    if (cache_budget)
+    {
+        key.text = text;
+        key.font_size = font_size;
+        key.color = ColorToInt(color);
+        key.bg = ColorToInt(bg);
+        key.spacing = spacing;
+        key.padding_width = padding_width;
+        key.padding_height = padding_height;
+        const auto found = cache.find(key);
+        if (found != cache.end())
+        {
+            ++cache_stats.hits;
+            cache_order.splice(cache_order.begin(), cache_order, found->second);
+            return found->second->surface;
+        }
+        ++cache_stats.misses;
+    }
+
+    const rl::Vector2 textSize = MeasureTextEx(font, text, font_size, spacing);
 
-    const int surfWidth = imageText.width + padding_width;
-    const int surfHeight = imageText.height + padding_height;
+    const int surfWidth = textSize.x + padding_width;
+    const int surfHeight = textSize.y + padding_height;
 
     const auto result = std::make_shared<Surface>(surfWidth, surfHeight);
     result->Fill(bg);
-    result->Blit(
-            texture, {padding_width / 2.0f, padding_height / 2.0f},
-            {0, 0, (float) texture.width, -(float) texture.height});
+    draw(result, text, {padding_width / 2.0f, padding_height / 2.0f}, color, spacing);
 
-    UnloadTextureSafe(texture);
-    UnloadImage(imageText);
+    const size_t bytes = (size_t) surfWidth * surfHeight * 4;
+    if (cache_budget && bytes <= cache_budget)
+    {
+        cache_order.push_front({key, result, bytes});
+        cache[key] = cache_order.begin();
+        cache_stats.bytes += bytes;
+        ++cache_stats.entries;
+        TrimCache();
+    }
     return result;
 }
 
+void rg::font::Font::draw(
+        const Surface_Ptr &surface, const char *text, const math::Vector2 position,
+        const rl::Color color, const float spacing, const float text_size) const
+{
+    surface->ToggleRender();
+    BeginDraw();
+    DrawTextEx(font, text, position.vector2, text_size > 0 ? text_size : font_size, spacing, color);
+    EndDraw();
+}
+
+bool rg::font::Font::IsSDF() const
+{
+    return sdf;
+}
+
 rg::math::Vector2 rg::font::Font::size(const char *text) const
 {
     return {MeasureTextEx(font, text, font_size, 1)};
 }
+
+void rg::font::Font::SetCacheBudget(const size_t bytes)
+{
+    cache_budget = bytes;
+    TrimCache();
+}
+
+rg::font::Font::CacheStats rg::font::Font::GetCacheStats() const
+{
+    return cache_stats;
+}
+
+void rg::font::Font::ClearCache()
+{
+    cache.clear();
+    cache_order.clear();
+    cache_stats.bytes = 0;
+    cache_stats.entries = 0;
+}
+
+void rg::font::Font::BeginDraw() const
+{
+    if (!sdf)
+    {
+        return;
+    }
+    if (!rygame.sdf_shader.id)
+    {
+        rygame.sdf_shader = rl::LoadShaderFromMemory(nullptr, sdf_fragment_shader);
+    }
+    BeginShaderMode(rygame.sdf_shader);
+}
+
+void rg::font::Font::EndDraw() const
+{
+    if (sdf)
+    {
+        rl::EndShaderMode();
+    }
+}
+
+void rg::font::Font::TrimCache() const
+{
+    while (!cache_order.empty() && cache_stats.bytes > cache_budget)
+    {
+        const CacheEntry &last = cache_order.back();
+        cache_stats.bytes -= last.bytes;
+        --cache_stats.entries;
+        ++cache_stats.evictions;
+        cache.erase(last.key);
+        cache_order.pop_back();
+    }
+}
+
+bool rg::font::Font::RenderKey::operator==(const RenderKey &other) const
+{
+    return text == other.text && font_size == other.font_size && color == other.color &&
+           bg == other.bg && spacing == other.spacing && padding_width == other.padding_width &&
+           padding_height == other.padding_height;
+}
+
+size_t rg::font::Font::RenderKeyHash::operator()(const RenderKey &key) const
+{
+    size_t result = std::hash<std::string>{}(key.text);
+    for (const size_t value:
+         {std::hash<float>{}(key.font_size), (size_t) key.color, (size_t) key.bg,
+          std::hash<float>{}(key.spacing), std::hash<float>{}(key.padding_width),
+          std::hash<float>{}(key.padding_height)})
+    {
+        result ^= value + 0x9e3779b9 + (result << 6) + (result >> 2);
+    }
+    return result;
+}
+
+int rg::font::Font::GlyphIndex(const int codepoint) const
+{
+    const auto found = glyph_indexes.find(codepoint);
+    if (found != glyph_indexes.end())
+    {
+        return found->second;
+    }
+    const int index = GetGlyphIndex(font, codepoint);
+    glyph_indexes[codepoint] = index;
+    return index;
+}
+
+std::pair<float, int> rg::font::Font::WordAdvance(const std::string &word) const
+{
+    const auto found = word_advances.find(word);
+    if (found != word_advances.end())
+    {
+        return found->second;
+    }
+    // chat logs have many different words, don't let it grow forever
+    if (word_advances.size() >= 8192)
+    {
+        word_advances.clear();
+    }
+    std::pair<float, int> result{0.0f, 0};
+    const char *text = word.c_str();
+    while (*text)
+    {
+        int codepointSize = 0;
+        const int index = GlyphIndex(rl::GetCodepointNext(text, &codepointSize));
+        text += codepointSize;
+        // same advance as DrawTextEx
+        const float advance = (float) font.glyphs[index].advanceX;
+        result.first += advance ? advance : font.recs[index].width;
+        ++result.second;
+    }
+    word_advances[word] = result;
+    return result;
+}
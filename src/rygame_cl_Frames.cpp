@@ -18,6 +18,22 @@ rg::Frames::Frames(const Surface_Ptr &surface, const int rows, const int cols)
     flip_atlas_height = -1;
 }
 
+rg::Frames::Frames(const Frames_Ptr &parent_frames, const Rect rect)
+    : Surface(parent_frames, rect)
+{
+    rows = rect.height / parent_frames->frames[0].height;
+    cols = rect.width / parent_frames->frames[0].width;
+    for (const auto &frame: parent_frames->frames)
+    {
+        if (frame.colliderect(rect))
+        {
+            frames.push_back(frame);
+        }
+    }
+    flip_atlas_height = -1;
+    SetAtlas();
+}
+
 void rg::Frames::SetAtlas(const int frame_index)
 {
     current_frame_index = (frame_index % (int) frames.size() + frames.size()) % frames.size();
@@ -88,29 +104,7 @@ void rg::Frames::SetColorKey(const rl::Color color)
 
 rg::Frames_Ptr rg::Frames::SubFrames(const Rect rect)
 {
-    const float frame_width = frames[0].width;
-    const float frame_height = frames[0].height;
-    int rows = rect.height / frame_height;
-    int cols = rect.width / frame_width;
-
-    auto result = std::make_shared<Frames>(GetTexture().width, GetTexture().height, rows, cols);
-    UnloadRenderTextureSafe(result->render);
-    result->render = render;
-    result->shared_texture = shared_texture;
-    result->parent = shared_from_this();
-    result->offset = rect.pos;
-
-    result->frames.clear();
-    for (const auto &frame: frames)
-    {
-        if (frame.colliderect(rect))
-        {
-            result->frames.push_back(frame);
-        }
-    }
-    result->SetAtlas();
-
-    return result;
+    return std::make_shared<Frames>(std::static_pointer_cast<Frames>(shared_from_this()), rect);
 }
 
 void rg::Frames::CreateFrames(const int width, const int height, int rows, int cols)
@@ -136,3 +130,21 @@ void rg::Frames::CreateFrames(const int width, const int height, int rows, int c
         }
     }
 }
+
+std::shared_ptr<rg::mask::Mask> rg::Frames::GetMask()
+{
+    if (cached_masks.size() != frames.size() || masks_draw_count != *draw_count)
+    {
+        // all frames masks from a single texture read
+        cached_masks = mask::MaskSet(std::static_pointer_cast<Frames>(shared_from_this())).masks;
+        masks_draw_count = *draw_count;
+    }
+    if (current_frame_index < 0 || current_frame_index >= (int) cached_masks.size())
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat("Frames has no mask for frame %d", current_frame_index));
+        return std::make_shared<mask::Mask>(0, 0);
+    }
+    return cached_masks[current_frame_index];
+}
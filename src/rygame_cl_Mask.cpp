@@ -1,48 +1,663 @@
 #include "rygame.hpp"
+#include "rygame_bits.hpp"
+#include <cmath>
 
 
-rg::mask::Mask::Mask(const unsigned int width, const unsigned int height, const bool fill)
+// 64 bits of `row` starting at bit `start`, which can be negative or past the row end.
+// Bits outside the row are 0.
+static uint64_t ShiftedWord(const uint64_t *row, const int words, const int start)
 {
-    auto *pixels = (unsigned char *) RL_CALLOC(width * height, sizeof(unsigned char));
-    image.format = rl::PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
-    image.width = width;
-    image.height = height;
-    image.mipmaps = 1;
+    const int q = start >= 0 ? start / 64 : -((63 - start) / 64);
+    const int r = start - q * 64;
+    const uint64_t low = q >= 0 && q < words ? row[q] : 0;
+    if (r == 0)
+    {
+        return low;
+    }
+    const uint64_t high = q + 1 >= 0 && q + 1 < words ? row[q + 1] : 0;
+    return (low >> r) | (high << (64 - r));
+}
 
-    unsigned char bit = 0;
-    if (fill)
+// Valid bits of the last word of a row `width` bits wide
+static uint64_t TailMask(const unsigned int width)
+{
+    const unsigned int tail = width % 64;
+    return tail ? (uint64_t{1} << tail) - 1 : ~uint64_t{0};
+}
+
+// Sets bits [start, end) of `row`
+static void SetRun(uint64_t *row, const int start, const int end)
+{
+    int x = start;
+    while (x < end)
     {
-        bit = 255;
+        const int bit = x % 64;
+        const int n = std::min(64 - bit, end - x);
+        const uint64_t run = n == 64 ? ~uint64_t{0} : ((uint64_t{1} << n) - 1) << bit;
+        row[x / 64] |= run;
+        x += n;
     }
-    for (int i = 0; i < image.width * image.height; ++i)
+}
+
+// Horizontal sequence of set bits [start, end) in row y
+struct Run
+{
+    int y;
+    int start;
+    int end;
+};
+
+// All runs of set bits, row by row, left to right
+static std::vector<Run> FindRuns(const rg::mask::Mask &mask)
+{
+    std::vector<Run> runs;
+    const int width = mask.get_size().x;
+    const int height = mask.get_size().y;
+    const int words = mask.WordsPerRow();
+    for (int y = 0; y < height; ++y)
     {
-        pixels[i] = bit;
+        const uint64_t *row = mask.Row(y);
+        bool in_run = false;
+        int start = 0;
+        for (int i = 0; i < words; ++i)
+        {
+            const uint64_t word = row[i];
+            if (!in_run && !word)
+            {
+                continue;
+            }
+            int pos = 0;
+            while (pos < 64)
+            {
+                // look for the next 1 outside a run, or the next 0 inside one
+                const uint64_t search = (in_run ? ~word : word) & (~uint64_t{0} << pos);
+                if (!search)
+                {
+                    break;
+                }
+                pos = FirstBit(search);
+                if (in_run)
+                {
+                    runs.push_back({y, start, i * 64 + pos});
+                }
+                else
+                {
+                    start = i * 64 + pos;
+                }
+                in_run = !in_run;
+            }
+        }
+        if (in_run)
+        {
+            runs.push_back({y, start, width});
+        }
     }
+    return runs;
+}
+
+static unsigned int FindRoot(std::vector<unsigned int> &parents, unsigned int i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+// Labels runs by 8 neighbors connectivity (union-find). Returns one label per run, labels
+// go from 0 to `*count - 1` in order of first appearance.
+static std::vector<unsigned int> LabelRuns(const std::vector<Run> &runs, unsigned int *count)
+{
+    std::vector<unsigned int> parents(runs.size());
+    for (unsigned int i = 0; i < runs.size(); ++i)
+    {
+        parents[i] = i;
+    }
+    // runs of the row above are [prev_begin, prev_end), current row starts at row_begin
+    size_t prev_begin = 0, prev_end = 0, row_begin = 0;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        if (runs[i].y != runs[row_begin].y)
+        {
+            const bool adjacent = runs[i].y == runs[row_begin].y + 1;
+            prev_begin = adjacent ? row_begin : i;
+            prev_end = i;
+            row_begin = i;
+        }
+        size_t j = prev_begin;
+        // skip previous runs that end before this one (diagonals count as touching)
+        while (j < prev_end && runs[j].end < runs[i].start)
+        {
+            ++j;
+        }
+        prev_begin = j;
+        for (; j < prev_end && runs[j].start <= runs[i].end; ++j)
+        {
+            const unsigned int a = FindRoot(parents, i);
+            const unsigned int b = FindRoot(parents, j);
+            if (a != b)
+            {
+                parents[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+    std::vector<unsigned int> labels(runs.size());
+    std::vector<unsigned int> root_label(runs.size(), ~0u);
+    *count = 0;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const unsigned int root = FindRoot(parents, i);
+        if (root_label[root] == ~0u)
+        {
+            root_label[root] = (*count)++;
+        }
+        labels[i] = root_label[root];
+    }
+    return labels;
+}
+
+// GRAYSCALE image with 255 for set bits and 0 for unset
+static rl::Image ToImage(const rg::mask::Mask &mask)
+{
+    const int width = mask.get_size().x;
+    const int height = mask.get_size().y;
+    auto *pixels = (unsigned char *) RL_CALLOC(width * height, sizeof(unsigned char));
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (mask.get_at(x, y))
+            {
+                pixels[y * width + x] = 255;
+            }
+        }
+    }
+    rl::Image image{};
     image.data = pixels;
+    image.width = width;
+    image.height = height;
+    image.mipmaps = 1;
+    image.format = rl::PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+    return image;
 }
 
-rg::mask::Mask::~Mask()
+rg::mask::Mask::Mask(const unsigned int width, const unsigned int height, const bool fill)
+    : width(width), height(height), words_per_row((width + 63) / 64),
+      bits(words_per_row * height, 0)
 {
-    UnloadImage(image);
+    atlas_rect = {0, 0, (float) width, (float) height};
+    if (fill)
+    {
+        this->fill();
+    }
 }
 
 rg::Surface_Ptr rg::mask::Mask::ToSurface() const
 {
+    const rl::Image image = ToImage(*this);
     const rl::Texture2D maskTexture = LoadTextureFromImageSafe(image);
-    const auto surface = std::make_shared<Surface>(image.width, image.height);
+    const auto surface = std::make_shared<Surface>(width, height);
     surface->Fill(rl::BLANK);
-    surface->Blit(maskTexture, {}, atlas_rect);
+    // rows are top to bottom, draw them unflipped (same as image::Load)
+    surface->Blit(maskTexture, {}, {0, 0, (float) width, -(float) height});
     UnloadTextureSafe(maskTexture);
+    UnloadImage(image);
     return surface;
 }
 
 rg::Frames_Ptr rg::mask::Mask::ToFrames(int rows, int cols) const
 {
+    const rl::Image image = ToImage(*this);
     const rl::Texture2D maskTexture = LoadTextureFromImageSafe(image);
-    const auto surface = std::make_shared<Frames>(image.width, image.height, rows, cols);
+    const auto surface = std::make_shared<Frames>(width, height, rows, cols);
     surface->Fill(rl::BLANK);
-    surface->Blit(maskTexture, {}, atlas_rect);
+    // Frames keep their render unflipped (same as Frames::Load)
+    surface->Blit(maskTexture, {}, {0, 0, (float) width, (float) height});
     surface->SetAtlas();
     UnloadTextureSafe(maskTexture);
+    UnloadImage(image);
     return surface;
 }
+
+rg::math::Vector2 rg::mask::Mask::get_size() const
+{
+    return {(float) width, (float) height};
+}
+
+rg::Rect rg::mask::Mask::get_rect() const
+{
+    return {0, 0, (float) width, (float) height};
+}
+
+bool rg::mask::Mask::get_at(const int x, const int y) const
+{
+    if (x < 0 || y < 0 || x >= (int) width || y >= (int) height)
+    {
+        return false;
+    }
+    return (bits[y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+void rg::mask::Mask::set_at(const int x, const int y, const bool value)
+{
+    if (x < 0 || y < 0 || x >= (int) width || y >= (int) height)
+    {
+        return;
+    }
+    const uint64_t bit = uint64_t{1} << (x % 64);
+    if (value)
+    {
+        bits[y * words_per_row + x / 64] |= bit;
+    }
+    else
+    {
+        bits[y * words_per_row + x / 64] &= ~bit;
+    }
+}
+
+void rg::mask::Mask::fill()
+{
+    if (!words_per_row)
+    {
+        return;
+    }
+    // keep bits past the width unset
+    const uint64_t last = TailMask(width);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        uint64_t *row = Row(y);
+        for (unsigned int i = 0; i < words_per_row - 1; ++i)
+        {
+            row[i] = ~uint64_t{0};
+        }
+        row[words_per_row - 1] = last;
+    }
+}
+
+void rg::mask::Mask::clear()
+{
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+bool rg::mask::Mask::overlap(
+        const Mask &other, const math::Vector2 offset, math::Vector2 *point) const
+{
+    const int ox = (int) std::floor(offset.x);
+    const int oy = (int) std::floor(offset.y);
+    const int x0 = std::max(0, ox);
+    const int x1 = std::min((int) width, ox + (int) other.width);
+    const int y0 = std::max(0, oy);
+    const int y1 = std::min((int) height, oy + (int) other.height);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return false;
+    }
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint64_t *row = Row(y);
+        const uint64_t *other_row = other.Row(y - oy);
+        for (int i = x0 / 64; i <= (x1 - 1) / 64; ++i)
+        {
+            const uint64_t both =
+                    row[i] & ShiftedWord(other_row, (int) other.words_per_row, i * 64 - ox);
+            if (both)
+            {
+                if (point)
+                {
+                    *point = {(float) (i * 64 + FirstBit(both)), (float) y};
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+unsigned int rg::mask::Mask::overlap_area(const Mask &other, const math::Vector2 offset) const
+{
+    const int ox = (int) std::floor(offset.x);
+    const int oy = (int) std::floor(offset.y);
+    const int x0 = std::max(0, ox);
+    const int x1 = std::min((int) width, ox + (int) other.width);
+    const int y0 = std::max(0, oy);
+    const int y1 = std::min((int) height, oy + (int) other.height);
+    unsigned int count = 0;
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return count;
+    }
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint64_t *row = Row(y);
+        const uint64_t *other_row = other.Row(y - oy);
+        for (int i = x0 / 64; i <= (x1 - 1) / 64; ++i)
+        {
+            count += PopCount(
+                    row[i] & ShiftedWord(other_row, (int) other.words_per_row, i * 64 - ox));
+        }
+    }
+    return count;
+}
+
+rg::mask::Mask rg::mask::Mask::overlap_mask(const Mask &other, const math::Vector2 offset) const
+{
+    Mask result(width, height);
+    const int ox = (int) std::floor(offset.x);
+    const int oy = (int) std::floor(offset.y);
+    const int x0 = std::max(0, ox);
+    const int x1 = std::min((int) width, ox + (int) other.width);
+    const int y0 = std::max(0, oy);
+    const int y1 = std::min((int) height, oy + (int) other.height);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return result;
+    }
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint64_t *row = Row(y);
+        const uint64_t *other_row = other.Row(y - oy);
+        uint64_t *result_row = result.Row(y);
+        for (int i = x0 / 64; i <= (x1 - 1) / 64; ++i)
+        {
+            result_row[i] =
+                    row[i] & ShiftedWord(other_row, (int) other.words_per_row, i * 64 - ox);
+        }
+    }
+    return result;
+}
+
+void rg::mask::Mask::draw(const Mask &other, const math::Vector2 offset)
+{
+    const int ox = (int) std::floor(offset.x);
+    const int oy = (int) std::floor(offset.y);
+    const int x0 = std::max(0, ox);
+    const int x1 = std::min((int) width, ox + (int) other.width);
+    const int y0 = std::max(0, oy);
+    const int y1 = std::min((int) height, oy + (int) other.height);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+    const uint64_t last = TailMask(width);
+    for (int y = y0; y < y1; ++y)
+    {
+        uint64_t *row = Row(y);
+        const uint64_t *other_row = other.Row(y - oy);
+        for (int i = x0 / 64; i <= (x1 - 1) / 64; ++i)
+        {
+            uint64_t word = ShiftedWord(other_row, (int) other.words_per_row, i * 64 - ox);
+            if (i == (int) words_per_row - 1)
+            {
+                word &= last;
+            }
+            row[i] |= word;
+        }
+    }
+}
+
+void rg::mask::Mask::erase(const Mask &other, const math::Vector2 offset)
+{
+    const int ox = (int) std::floor(offset.x);
+    const int oy = (int) std::floor(offset.y);
+    const int x0 = std::max(0, ox);
+    const int x1 = std::min((int) width, ox + (int) other.width);
+    const int y0 = std::max(0, oy);
+    const int y1 = std::min((int) height, oy + (int) other.height);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+    for (int y = y0; y < y1; ++y)
+    {
+        uint64_t *row = Row(y);
+        const uint64_t *other_row = other.Row(y - oy);
+        for (int i = x0 / 64; i <= (x1 - 1) / 64; ++i)
+        {
+            row[i] &= ~ShiftedWord(other_row, (int) other.words_per_row, i * 64 - ox);
+        }
+    }
+}
+
+void rg::mask::Mask::invert()
+{
+    if (!words_per_row)
+    {
+        return;
+    }
+    const uint64_t last = TailMask(width);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        uint64_t *row = Row(y);
+        for (unsigned int i = 0; i < words_per_row; ++i)
+        {
+            row[i] = ~row[i];
+        }
+        row[words_per_row - 1] &= last;
+    }
+}
+
+rg::mask::Mask rg::mask::Mask::scale(const math::Vector2 size) const
+{
+    const int new_width = size.x > 0 ? (int) size.x : 0;
+    const int new_height = size.y > 0 ? (int) size.y : 0;
+    Mask result(new_width, new_height);
+    if (!width || !height)
+    {
+        return result;
+    }
+    int previous_y = -1;
+    for (int y = 0; y < new_height; ++y)
+    {
+        const int source_y = (int) ((int64_t) y * height / new_height);
+        uint64_t *result_row = result.Row(y);
+        if (source_y == previous_y)
+        {
+            // same source row, copy the row already scaled
+            std::copy(result_row - result.words_per_row, result_row, result_row);
+            continue;
+        }
+        previous_y = source_y;
+        const uint64_t *row = Row(source_y);
+        for (int x = 0; x < new_width; ++x)
+        {
+            const int source_x = (int) ((int64_t) x * width / new_width);
+            if ((row[source_x / 64] >> (source_x % 64)) & 1)
+            {
+                result_row[x / 64] |= uint64_t{1} << (x % 64);
+            }
+        }
+    }
+    return result;
+}
+
+unsigned int rg::mask::Mask::count() const
+{
+    unsigned int total = 0;
+    for (const uint64_t word: bits)
+    {
+        total += PopCount(word);
+    }
+    return total;
+}
+
+rg::math::Vector2 rg::mask::Mask::centroid() const
+{
+    uint64_t total = 0, sum_x = 0, sum_y = 0;
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        const uint64_t *row = Row(y);
+        for (unsigned int i = 0; i < words_per_row; ++i)
+        {
+            uint64_t word = row[i];
+            const unsigned int n = PopCount(word);
+            total += n;
+            sum_y += (uint64_t) n * y;
+            while (word)
+            {
+                sum_x += i * 64 + FirstBit(word);
+                word &= word - 1;
+            }
+        }
+    }
+    if (!total)
+    {
+        return {};
+    }
+    return {(float) sum_x / total, (float) sum_y / total};
+}
+
+std::vector<rg::math::Vector2> rg::mask::Mask::outline(const int every) const
+{
+    std::vector<math::Vector2> points;
+    // first set bit
+    int start_x = -1, start_y = -1;
+    for (unsigned int y = 0; y < height && start_x < 0; ++y)
+    {
+        const uint64_t *row = Row(y);
+        for (unsigned int i = 0; i < words_per_row; ++i)
+        {
+            if (row[i])
+            {
+                start_x = i * 64 + FirstBit(row[i]);
+                start_y = y;
+                break;
+            }
+        }
+    }
+    if (start_x < 0)
+    {
+        return points;
+    }
+
+    // clockwise neighbors (y grows down): E, SE, S, SW, W, NW, N, NE
+    static constexpr int dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+    static constexpr int dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    // direction index from a cell to its neighbor at (dx + 1, dy + 1)
+    static constexpr int direction[3][3] = {{5, 4, 3}, {6, -1, 2}, {7, 0, 1}};
+
+    // Moore neighbor tracing. `back` is the direction of a background neighbor of the current
+    // pixel; the search for the next border pixel starts clockwise from it.
+    // The first pixel in scan order always has its West neighbor unset.
+    int x = start_x, y = start_y, back = 4;
+    int first_direction = -1;
+    int step = 0;
+    points.push_back({(float) x, (float) y});
+    while (true)
+    {
+        int next = -1;
+        for (int k = 1; k <= 8; ++k)
+        {
+            const int d = (back + k) % 8;
+            if (get_at(x + dx[d], y + dy[d]))
+            {
+                next = d;
+                break;
+            }
+        }
+        if (next < 0)
+        {
+            break; // single pixel
+        }
+        if (x == start_x && y == start_y)
+        {
+            if (first_direction == next)
+            {
+                break; // the trace is about to repeat itself
+            }
+            if (first_direction < 0)
+            {
+                first_direction = next;
+            }
+        }
+        // the background neighbor checked just before `next`, seen from the new pixel
+        const int previous = (next + 7) % 8;
+        const int bx = x + dx[previous];
+        const int by = y + dy[previous];
+        x += dx[next];
+        y += dy[next];
+        back = direction[bx - x + 1][by - y + 1];
+        if (x == start_x && y == start_y)
+        {
+            continue;
+        }
+        if (++step % (every > 0 ? every : 1) == 0)
+        {
+            points.push_back({(float) x, (float) y});
+        }
+    }
+    return points;
+}
+
+std::vector<rg::Rect> rg::mask::Mask::get_bounding_rects() const
+{
+    const std::vector<Run> runs = FindRuns(*this);
+    unsigned int components = 0;
+    const std::vector<unsigned int> labels = LabelRuns(runs, &components);
+    std::vector<int> min_x(components, INT32_MAX), min_y(components, INT32_MAX);
+    std::vector<int> max_x(components, -1), max_y(components, -1);
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const unsigned int label = labels[i];
+        min_x[label] = std::min(min_x[label], runs[i].start);
+        max_x[label] = std::max(max_x[label], runs[i].end);
+        min_y[label] = std::min(min_y[label], runs[i].y);
+        max_y[label] = std::max(max_y[label], runs[i].y + 1);
+    }
+    std::vector<Rect> rects;
+    rects.reserve(components);
+    for (unsigned int c = 0; c < components; ++c)
+    {
+        rects.push_back(
+                {(float) min_x[c], (float) min_y[c], (float) (max_x[c] - min_x[c]),
+                 (float) (max_y[c] - min_y[c])});
+    }
+    return rects;
+}
+
+std::vector<rg::mask::Mask> rg::mask::Mask::connected_components(const unsigned int min) const
+{
+    const std::vector<Run> runs = FindRuns(*this);
+    unsigned int components = 0;
+    const std::vector<unsigned int> labels = LabelRuns(runs, &components);
+    std::vector<unsigned int> sizes(components, 0);
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        sizes[labels[i]] += runs[i].end - runs[i].start;
+    }
+    // position of each kept component in the result
+    std::vector<int> positions(components, -1);
+    std::vector<Mask> result;
+    for (unsigned int c = 0; c < components; ++c)
+    {
+        if (sizes[c] >= min)
+        {
+            positions[c] = result.size();
+            result.emplace_back(width, height);
+        }
+    }
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const int position = positions[labels[i]];
+        if (position >= 0)
+        {
+            SetRun(result[position].Row(runs[i].y), runs[i].start, runs[i].end);
+        }
+    }
+    return result;
+}
+
+const uint64_t *rg::mask::Mask::Row(const int y) const
+{
+    return bits.data() + y * words_per_row;
+}
+
+uint64_t *rg::mask::Mask::Row(const int y)
+{
+    return bits.data() + y * words_per_row;
+}
+
+unsigned int rg::mask::Mask::WordsPerRow() const
+{
+    return words_per_row;
+}
@@ -0,0 +1,38 @@
+#include "rygame.hpp"
+
+
+rg::mask::MaskSet::MaskSet(const Frames_Ptr &frames, const unsigned char threshold)
+{
+    const rl::Image image = LoadImageFromTextureSafe(frames->GetTexture());
+    masks.reserve(frames->frames.size());
+    for (const auto &frame: frames->frames)
+    {
+        // Frames render is not flipped, frames are read as they are stored
+        auto frame_mask = std::make_shared<Mask>(FromImage(image, frame, threshold));
+        frame_mask->atlas_rect = frame;
+        masks.push_back(frame_mask);
+    }
+    UnloadImage(image);
+}
+
+const std::shared_ptr<rg::mask::Mask> &rg::mask::MaskSet::Get(const int frame_index) const
+{
+    const int count = masks.size();
+    if (!count)
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("MaskSet has no masks"));
+        static const std::shared_ptr<Mask> empty = std::make_shared<Mask>(0, 0);
+        return empty;
+    }
+    return masks[(frame_index % count + count) % count];
+}
+
+const std::shared_ptr<rg::mask::Mask> &rg::mask::MaskSet::Current(const Frames_Ptr &frames) const
+{
+    return Get(frames->current_frame_index);
+}
+
+unsigned int rg::mask::MaskSet::size() const
+{
+    return masks.size();
+}
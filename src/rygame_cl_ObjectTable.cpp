@@ -0,0 +1,160 @@
+#include "rygame.hpp"
+
+
+#ifdef WITH_TMX
+static void CopyProperty(rl::tmx_property *property, void *userdata)
+{
+    auto &properties = *(std::unordered_map<std::string, rg::tmx::Property> *) userdata;
+    rg::tmx::Property &result = properties[property->name];
+    result.type = property->type;
+    switch (property->type)
+    {
+        case rl::PT_INT:
+            result.integer = property->value.integer;
+            break;
+        case rl::PT_BOOL:
+            result.integer = property->value.boolean;
+            break;
+        case rl::PT_OBJECT:
+            result.integer = property->value.object_id;
+            break;
+        case rl::PT_FLOAT:
+            result.decimal = property->value.decimal;
+            break;
+        case rl::PT_STRING:
+            result.string = property->value.string ? property->value.string : "";
+            break;
+        case rl::PT_FILE:
+            result.string = property->value.file ? property->value.file : "";
+            break;
+        case rl::PT_COLOR:
+            result.color = rl::ColorFromTMX(property->value.color);
+            break;
+        case rl::PT_NONE:
+        case rl::PT_CUSTOM:
+            break;
+    }
+}
+
+rg::tmx::ObjectTable::ObjectTable(const rl::tmx_map *map, const float cell_size)
+    : grid(cell_size)
+{
+    AddLayers(map->ly_head);
+    for (unsigned int i = 0; i < objects.size(); ++i)
+    {
+        grid.Insert(i, objects[i].rect);
+    }
+}
+
+const std::vector<unsigned int> &
+rg::tmx::ObjectTable::FindByName(const std::string &name) const
+{
+    static const std::vector<unsigned int> none{};
+    const auto found = names.find(name);
+    return found == names.end() ? none : found->second;
+}
+
+const std::vector<unsigned int> &
+rg::tmx::ObjectTable::FindByType(const std::string &type) const
+{
+    static const std::vector<unsigned int> none{};
+    const auto found = types.find(type);
+    return found == types.end() ? none : found->second;
+}
+
+const rg::tmx::Object *rg::tmx::ObjectTable::GetById(const unsigned int id) const
+{
+    const auto found = ids.find(id);
+    return found == ids.end() ? nullptr : &objects[found->second];
+}
+
+std::vector<unsigned int> rg::tmx::ObjectTable::Query(const Rect &area) const
+{
+    std::vector<unsigned int> result;
+    for (const unsigned int index: grid.Query(area))
+    {
+        // touching counts, points have no size
+        const Rect &rect = objects[index].rect;
+        if (rect.x <= area.x + area.width && rect.x + rect.width >= area.x &&
+            rect.y <= area.y + area.height && rect.y + rect.height >= area.y)
+        {
+            result.push_back(index);
+        }
+    }
+    return result;
+}
+
+void rg::tmx::ObjectTable::AddLayers(const rl::tmx_layer *layer)
+{
+    for (; layer; layer = layer->next)
+    {
+        if (layer->type == rl::L_GROUP)
+        {
+            AddLayers(layer->content.group_head);
+            continue;
+        }
+        if (layer->type != rl::L_OBJGR || !layer->content.objgr)
+        {
+            continue;
+        }
+        for (const rl::tmx_object *obj = layer->content.objgr->head; obj; obj = obj->next)
+        {
+            Object object;
+            object.id = obj->id;
+            object.name = obj->name ? obj->name : "";
+            object.type = obj->type ? obj->type : "";
+            object.layer = layer->name ? layer->name : "";
+            object.obj_type = obj->obj_type;
+            object.rotation = (float) obj->rotation;
+            object.rect = {(float) obj->x, (float) obj->y, (float) obj->width,
+                           (float) obj->height};
+            switch (obj->obj_type)
+            {
+                case rl::OT_TILE:
+                    object.rect.pos = GetTMXObjPosition(obj);
+                    object.gid = obj->content.gid & TMX_FLIP_BITS_REMOVAL;
+                    break;
+                case rl::OT_POLYGON:
+                case rl::OT_POLYLINE:
+                {
+                    const rl::tmx_shape *shape = obj->content.shape;
+                    for (int i = 0; shape && i < shape->points_len; ++i)
+                    {
+                        object.points.push_back(
+                                {(float) (obj->x + shape->points[i][0]),
+                                 (float) (obj->y + shape->points[i][1])});
+                    }
+                    if (object.points.empty())
+                    {
+                        break;
+                    }
+                    math::Vector2 low = object.points[0], high = object.points[0];
+                    for (const auto &point: object.points)
+                    {
+                        low = {std::min(low.x, point.x), std::min(low.y, point.y)};
+                        high = {std::max(high.x, point.x), std::max(high.y, point.y)};
+                    }
+                    object.rect = {low.x, low.y, high.x - low.x, high.y - low.y};
+                    break;
+                }
+                case rl::OT_NONE:
+                case rl::OT_SQUARE:
+                case rl::OT_ELLIPSE:
+                case rl::OT_TEXT:
+                case rl::OT_POINT:
+                    break;
+            }
+            if (obj->properties)
+            {
+                rl::tmx_property_foreach(obj->properties, CopyProperty, &object.properties);
+            }
+
+            const auto index = (unsigned int) objects.size();
+            names[object.name].push_back(index);
+            types[object.type].push_back(index);
+            ids[object.id] = index;
+            objects.push_back(std::move(object));
+        }
+    }
+}
+#endif // WITH_TMX
@@ -1,5 +1,13 @@
 #include "rygame.hpp"
 #include <cassert>
+#if defined(__AVX__)
+#include <immintrin.h>
+#define RYGAME_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RYGAME_SSE2
+#endif
 
 /* For use with the Cohen-Sutherland algorithm for line clipping, in SDL_rect_impl.h */
 #define CODE_BOTTOM 1
@@ -305,6 +313,128 @@ bool rg::Rect::colliderect(const Rect &other) const
     return CheckCollisionRecs(rectangle, other.rectangle);
 }
 
+// Same test as raylib's CheckCollisionRecs
+static bool Overlaps(const rg::Rect &a, const rg::Rect &b)
+{
+    return a.x < b.x + b.width && a.x + a.width > b.x && a.y < b.y + b.height &&
+           a.y + a.height > b.y;
+}
+
+// Tests `rect` against `count` rects, calling `hit(index)` for each overlap in increasing
+// order, until it returns true. Rects are transposed to SoA (x, y, w, h lanes) and tested
+// 8 (AVX) or 4 (SSE2) at a time.
+template<typename Hit>
+static void CollideRects(const rg::Rect &rect, const rg::Rect *rects, const size_t count, Hit hit)
+{
+    size_t i = 0;
+#ifdef RYGAME_AVX
+    {
+        const __m256 ax = _mm256_set1_ps(rect.x);
+        const __m256 ay = _mm256_set1_ps(rect.y);
+        const __m256 ar = _mm256_set1_ps(rect.x + rect.width);
+        const __m256 ab = _mm256_set1_ps(rect.y + rect.height);
+        for (; i + 8 <= count; i += 8)
+        {
+            // each register holds 2 rects, one per 128 bit lane
+            const float *p = &rects[i].x;
+            __m256 r0 = _mm256_loadu_ps(p);
+            __m256 r1 = _mm256_loadu_ps(p + 8);
+            __m256 r2 = _mm256_loadu_ps(p + 16);
+            __m256 r3 = _mm256_loadu_ps(p + 24);
+            // transpose inside each lane: x = {x0, x2, x4, x6 | x1, x3, x5, x7}
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            const __m256 bx = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 by = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 bw = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 bh = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 m = _mm256_cmp_ps(ax, _mm256_add_ps(bx, bw), _CMP_LT_OQ);
+            m = _mm256_and_ps(m, _mm256_cmp_ps(ar, bx, _CMP_GT_OQ));
+            m = _mm256_and_ps(m, _mm256_cmp_ps(ay, _mm256_add_ps(by, bh), _CMP_LT_OQ));
+            m = _mm256_and_ps(m, _mm256_cmp_ps(ab, by, _CMP_GT_OQ));
+            const int bits = _mm256_movemask_ps(m);
+            if (!bits)
+            {
+                continue;
+            }
+            // lane bit b holds rect 2 * b (low lane) or 2 * (b - 4) + 1 (high lane)
+            for (unsigned int k = 0; k < 8; ++k)
+            {
+                const unsigned int b = (k & 1) * 4 + k / 2;
+                if (bits >> b & 1 && hit(i + k))
+                {
+                    return;
+                }
+            }
+        }
+    }
+#endif
+#ifdef RYGAME_SSE2
+    {
+        const __m128 ax = _mm_set1_ps(rect.x);
+        const __m128 ay = _mm_set1_ps(rect.y);
+        const __m128 ar = _mm_set1_ps(rect.x + rect.width);
+        const __m128 ab = _mm_set1_ps(rect.y + rect.height);
+        for (; i + 4 <= count; i += 4)
+        {
+            const float *p = &rects[i].x;
+            __m128 bx = _mm_loadu_ps(p);
+            __m128 by = _mm_loadu_ps(p + 4);
+            __m128 bw = _mm_loadu_ps(p + 8);
+            __m128 bh = _mm_loadu_ps(p + 12);
+            _MM_TRANSPOSE4_PS(bx, by, bw, bh);
+            __m128 m = _mm_cmplt_ps(ax, _mm_add_ps(bx, bw));
+            m = _mm_and_ps(m, _mm_cmpgt_ps(ar, bx));
+            m = _mm_and_ps(m, _mm_cmplt_ps(ay, _mm_add_ps(by, bh)));
+            m = _mm_and_ps(m, _mm_cmpgt_ps(ab, by));
+            const int bits = _mm_movemask_ps(m);
+            for (unsigned int k = 0; bits && k < 4; ++k)
+            {
+                if (bits >> k & 1 && hit(i + k))
+                {
+                    return;
+                }
+            }
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if (Overlaps(rect, rects[i]) && hit(i))
+        {
+            return;
+        }
+    }
+}
+
+int rg::Rect::collidelist(const std::vector<Rect> &rects) const
+{
+    int result = -1;
+    CollideRects(
+            *this, rects.data(), rects.size(),
+            [&result](const size_t index)
+            {
+                result = (int) index;
+                return true;
+            });
+    return result;
+}
+
+std::vector<int> rg::Rect::collidelistall(const std::vector<Rect> &rects) const
+{
+    std::vector<int> result;
+    CollideRects(
+            *this, rects.data(), rects.size(),
+            [&result](const size_t index)
+            {
+                result.push_back((int) index);
+                return false;
+            });
+    return result;
+}
+
 rg::Line rg::Rect::clipline(const Line line)
 {
     return clipline(line.start, line.end);
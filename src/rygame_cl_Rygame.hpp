@@ -1,7 +1,40 @@
 #pragma once
 #include "rygame.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 
+// A voice of the mixer pool, `alias` shares the samples of `sound`
+struct MixerVoice
+{
+    void Release()
+    {
+        if (sound)
+        {
+            rl::StopSound(alias);
+            rl::UnloadSoundAlias(alias);
+        }
+        sound = nullptr;
+        alias = {};
+    }
+
+    rl::Sound alias{};
+    const rg::mixer::Sound *sound = nullptr;
+    int loops = 0; // times left to repeat, -1 forever
+    int priority = 0;
+    float volume = 1.0f;
+    unsigned int order = 0; // when it started playing, oldest voices are stolen first
+    bool paused = false;
+    bool positional = false;
+    rg::math::Vector2 position{};
+    float gain = 1.0f; // distance attenuation applied to the alias
+    float pan = 0.5f; // pan applied to the alias, 0.5 is center, 1 is left
+};
+
+// Sets gain and pan of a positional `voice` from its distance to the listener
+void SpatializeVoice(MixerVoice &voice);
+
 class Rygame
 {
 public:
@@ -9,20 +42,49 @@ public:
     Rygame() = default;
     ~Rygame()
     {
+        StopMusicThread();
         if (display_surface)
         {
             display_surface.reset();
+            if (sdf_shader.id)
+            {
+                rl::UnloadShader(sdf_shader);
+            }
             if (isSoundInit)
             {
+                for (auto &voice: voices)
+                {
+                    voice.Release();
+                }
+                voices.clear();
                 rl::CloseAudioDevice();
             }
             rl::CloseWindow();
         }
     };
 
+    void StopMusicThread()
+    {
+        music_running = false;
+        if (music_thread.joinable())
+        {
+            music_thread.join();
+        }
+    }
+
     rg::Surface_Ptr display_surface = nullptr;
     unsigned int current_render = 0;
     bool isSoundInit = false;
     bool shouldQuit = false;
     std::vector<rg::mixer::Sound *> musics;
+    // musics are refilled in music_thread, music_mutex guards them and the musics list
+    std::thread music_thread;
+    std::mutex music_mutex;
+    std::atomic<bool> music_running{false};
+    std::vector<MixerVoice> voices = std::vector<MixerVoice>(8);
+    unsigned int voice_order = 0;
+    rg::math::Vector2 listener{};
+    float min_distance = 0.0f;
+    float max_distance = 1000.0f;
+    rl::Shader sdf_shader{}; // loaded on first SDF font draw
 };
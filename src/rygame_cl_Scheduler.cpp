@@ -0,0 +1,195 @@
+#include "rygame.hpp"
+#include <cmath>
+
+
+#define WHEEL_BITS 8
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+
+rg::time::Scheduler::Scheduler(const float resolution)
+    : resolution(resolution > 0.0f ? resolution : 1.0f / 120.0f),
+      heads(WHEEL_LEVELS * WHEEL_SIZE, -1)
+{}
+
+uint64_t rg::time::Scheduler::Schedule(
+        const float delay, const std::function<void()> &func, const float interval)
+{
+    int index;
+    if (!free_nodes.empty())
+    {
+        index = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    else
+    {
+        index = (int) nodes.size();
+        nodes.push_back({});
+        nodes[index].generation = 0;
+    }
+    Node &node = nodes[index];
+    // never early: the tick at or after elapsed + delay, and never the one already run
+    const double expiry = std::ceil((elapsed + std::max(delay, 0.0f)) / resolution - 1e-6);
+    node.func = func;
+    node.expiry = std::max((uint64_t) expiry, current + 1);
+    node.interval = interval > 0.0f
+                            ? std::max<uint64_t>(std::llround(interval / resolution), 1)
+                            : 0;
+    // handles start at generation 1, so 0 is never a handle
+    ++node.generation;
+    Insert(index);
+    ++pending;
+    return (uint64_t) node.generation << 32 | (uint32_t) index;
+}
+
+void rg::time::Scheduler::Cancel(const uint64_t handle)
+{
+    const int index = Find(handle);
+    if (index == -1)
+    {
+        return;
+    }
+    Unlink(index);
+    nodes[index].func = nullptr;
+    free_nodes.push_back(index);
+    --pending;
+}
+
+bool rg::time::Scheduler::IsPending(const uint64_t handle) const
+{
+    return Find(handle) != -1;
+}
+
+void rg::time::Scheduler::Update(const float deltaTime)
+{
+    elapsed += deltaTime;
+    const auto target = (uint64_t) std::floor(elapsed / resolution + 1e-6);
+    if (!pending)
+    {
+        // nothing can fire, skip the ticks
+        current = std::max(current, target);
+        return;
+    }
+    while (current < target)
+    {
+        ++current;
+        RunTick();
+    }
+}
+
+double rg::time::Scheduler::GetTime() const
+{
+    return elapsed;
+}
+
+unsigned int rg::time::Scheduler::size() const
+{
+    return pending;
+}
+
+void rg::time::Scheduler::Insert(const int index)
+{
+    Node &node = nodes[index];
+    // beyond the last level, it is placed as far as possible and moved again later
+    constexpr uint64_t max_delta = ((uint64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+    const uint64_t delta = node.expiry - current;
+    const uint64_t expiry = delta > max_delta ? current + max_delta : node.expiry;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && (expiry - current) >> (WHEEL_BITS * (level + 1)))
+    {
+        ++level;
+    }
+    const int slot =
+            level * WHEEL_SIZE + (int) ((expiry >> (WHEEL_BITS * level)) & WHEEL_MASK);
+    node.slot = slot;
+    node.prev = -1;
+    node.next = heads[slot];
+    if (node.next != -1)
+    {
+        nodes[node.next].prev = index;
+    }
+    heads[slot] = index;
+}
+
+void rg::time::Scheduler::Unlink(const int index)
+{
+    Node &node = nodes[index];
+    if (node.prev != -1)
+    {
+        nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        heads[node.slot] = node.next;
+    }
+    if (node.next != -1)
+    {
+        nodes[node.next].prev = node.prev;
+    }
+    node.slot = -1;
+}
+
+void rg::time::Scheduler::Cascade(const int slot)
+{
+    int index = heads[slot];
+    heads[slot] = -1;
+    while (index != -1)
+    {
+        const int next = nodes[index].next;
+        Insert(index);
+        index = next;
+    }
+}
+
+void rg::time::Scheduler::RunTick()
+{
+    // at each turn of a level, the next level slot for the coming turn is spread below
+    for (int level = 1; level < WHEEL_LEVELS; ++level)
+    {
+        if ((current >> (WHEEL_BITS * (level - 1))) & WHEEL_MASK)
+        {
+            break;
+        }
+        Cascade(level * WHEEL_SIZE + (int) ((current >> (WHEEL_BITS * level)) & WHEEL_MASK));
+    }
+
+    const int slot = (int) (current & WHEEL_MASK);
+    while (heads[slot] != -1)
+    {
+        const int index = heads[slot];
+        Unlink(index);
+        // func is moved out, it can cancel its own node or schedule others (nodes may grow)
+        std::function<void()> func = std::move(nodes[index].func);
+        const uint32_t generation = nodes[index].generation;
+        if (nodes[index].interval)
+        {
+            nodes[index].expiry += nodes[index].interval;
+            Insert(index);
+        }
+        else
+        {
+            free_nodes.push_back(index);
+            --pending;
+        }
+        if (func)
+        {
+            func();
+        }
+        if (nodes[index].generation == generation && nodes[index].slot != -1)
+        {
+            nodes[index].func = std::move(func);
+        }
+    }
+}
+
+int rg::time::Scheduler::Find(const uint64_t handle) const
+{
+    const auto index = (int) (uint32_t) handle;
+    const auto generation = (uint32_t) (handle >> 32);
+    if (index < 0 || index >= (int) nodes.size() || nodes[index].generation != generation ||
+        nodes[index].slot == -1)
+    {
+        return -1;
+    }
+    return index;
+}
@@ -1,24 +1,44 @@
 #include "rygame.hpp"
 #include "rygame_cl_Rygame.hpp"
+#include <chrono>
 
 
 extern Rygame rygame;
 
-rg::mixer::Sound::Sound(const char *file, const bool isMusic) : isMusic(isMusic), file(file)
+// Refills the music streams, independent of the frame rate. Musics are only locked while
+// they are refilled, a few ms each time.
+static void MusicThread()
 {
-    if (!rygame.isSoundInit)
+    while (rygame.music_running)
     {
-        rl::InitAudioDevice();
-        rygame.isSoundInit = rl::IsAudioDeviceReady();
+        {
+            std::lock_guard lock(rygame.music_mutex);
+            for (const auto &music: rygame.musics)
+            {
+                UpdateMusicStream(*(rl::Music *) music->audio.get());
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
+}
+
+rg::mixer::Sound::Sound(const char *file, const bool isMusic) : isMusic(isMusic), file(file)
+{
+    InitAudio();
     if (isMusic)
     {
-        audio = std::make_shared<rl::Music>(rl::LoadMusicStream(file));
+        audio = std::make_shared<rl::Music>(rl::LoadMusicStream(this->file.c_str()));
+        std::lock_guard lock(rygame.music_mutex);
         rygame.musics.push_back(this);
+        if (!rygame.music_running)
+        {
+            rygame.music_running = true;
+            rygame.music_thread = std::thread(MusicThread);
+        }
     }
     else
     {
-        audio = std::make_shared<rl::Sound>(rl::LoadSound(file));
+        audio = std::make_shared<rl::Sound>(rl::LoadSound(this->file.c_str()));
     }
 }
 
@@ -26,33 +46,48 @@ rg::mixer::Sound::~Sound()
 {
     if (isMusic)
     {
+        std::lock_guard lock(rygame.music_mutex);
         rygame.musics.erase(
                 std::remove(rygame.musics.begin(), rygame.musics.end(), this), rygame.musics.end());
         UnloadMusicStream(*(rl::Music *) audio.get());
     }
-    else
+    else if (audio)
     {
+        // aliases must be unloaded before the sound they share
+        for (auto &voice: rygame.voices)
+        {
+            if (voice.sound == this)
+            {
+                voice.Release();
+            }
+        }
         UnloadSound(*(rl::Sound *) audio.get());
     }
 }
 
-// TODO - param to allow repetitions
-void rg::mixer::Sound::Play() const
+rg::mixer::Channel rg::mixer::Sound::Play(const int loops, const int priority) const
 {
     if (isMusic)
     {
+        std::lock_guard lock(rygame.music_mutex);
         PlayMusicStream(*(rl::Music *) audio.get());
+        return Channel();
     }
-    else
+    if (!Decode())
     {
-        PlaySound(*(rl::Sound *) audio.get());
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("Sound %s can't be played", file.c_str()));
+        return Channel();
     }
+    const Channel channel = find_channel(true, priority);
+    channel.play(*this, loops, priority);
+    return channel;
 }
 
 void rg::mixer::Sound::Stop() const
 {
     if (isMusic)
     {
+        std::lock_guard lock(rygame.music_mutex);
         if (IsMusicStreamPlaying(*(rl::Music *) audio.get()))
         {
             StopMusicStream(*(rl::Music *) audio.get());
@@ -60,10 +95,12 @@ void rg::mixer::Sound::Stop() const
     }
     else
     {
-
-        if (IsSoundPlaying(*(rl::Sound *) audio.get()))
+        for (int i = 0; i < (int) rygame.voices.size(); ++i)
         {
-            StopSound(*(rl::Sound *) audio.get());
+            if (rygame.voices[i].sound == this)
+            {
+                Channel(i).stop();
+            }
         }
     }
 }
@@ -72,15 +109,58 @@ void rg::mixer::Sound::SetVolume(const float value) const
 {
     if (isMusic)
     {
+        std::lock_guard lock(rygame.music_mutex);
         SetMusicVolume(*(rl::Music *) audio.get(), value);
     }
     else
     {
-        SetSoundVolume(*(rl::Sound *) audio.get(), value);
+        volume = value;
+        for (const auto &voice: rygame.voices)
+        {
+            if (voice.sound == this)
+            {
+                SetSoundVolume(voice.alias, voice.volume * voice.gain * value);
+            }
+        }
     }
 }
 
+float rg::mixer::Sound::GetVolume() const
+{
+    return volume;
+}
+
 const char *rg::mixer::Sound::GetFilename() const
 {
-    return file;
+    return file.c_str();
+}
+
+void rg::mixer::Sound::InitAudio()
+{
+    if (!rygame.isSoundInit)
+    {
+        rl::InitAudioDevice();
+        rygame.isSoundInit = rl::IsAudioDeviceReady();
+    }
+}
+
+bool rg::mixer::Sound::Decode() const
+{
+    if (!audio || isMusic)
+    {
+        return false;
+    }
+    if (!compressed.empty())
+    {
+        const rl::Wave wave = rl::LoadWaveFromMemory(
+                rl::GetFileExtension(file.c_str()), compressed.data(), (int) compressed.size());
+        if (wave.data)
+        {
+            *(rl::Sound *) audio.get() = LoadSoundFromWave(wave);
+            UnloadWave(wave);
+        }
+        std::vector<unsigned char>().swap(compressed);
+    }
+    // no samples if the file is missing or couldn't be decoded
+    return ((rl::Sound *) audio.get())->stream.buffer != nullptr;
 }
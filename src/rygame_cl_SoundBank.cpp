@@ -0,0 +1,163 @@
+#include "rygame.hpp"
+#include <atomic>
+#include <thread>
+
+
+static bool IsSoundFile(const std::filesystem::path &path)
+{
+    const std::string extension = path.extension().string();
+    return extension == ".wav" || extension == ".ogg" || extension == ".mp3" ||
+           extension == ".flac" || extension == ".qoa";
+}
+
+rg::mixer::SoundBank::SoundBank(const char *path, const int lazy_size) : lazy_size(lazy_size)
+{
+    std::vector<std::string> files, names;
+    for (const auto &dirEntry: std::filesystem::recursive_directory_iterator(path))
+    {
+        if (!dirEntry.is_regular_file() || !IsSoundFile(dirEntry.path()))
+        {
+            continue;
+        }
+        const std::string name = dirEntry.path().stem().string();
+        if (std::find(names.begin(), names.end(), name) != names.end())
+        {
+            TraceLog(
+                    rl::LOG_WARNING,
+                    rl::TextFormat(
+                            "SoundBank already has a sound %s, skipping %s", name.c_str(),
+                            dirEntry.path().string().c_str()));
+            continue;
+        }
+        files.push_back(dirEntry.path().string());
+        names.push_back(name);
+    }
+    LoadFiles(files, names);
+}
+
+const rg::mixer::Sound *rg::mixer::SoundBank::Get(const std::string &name) const
+{
+    const auto sound = sounds.find(name);
+    if (sound == sounds.end())
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("SoundBank has no sound %s", name.c_str()));
+        return nullptr;
+    }
+    return &sound->second;
+}
+
+const rg::mixer::Sound *rg::mixer::SoundBank::Load(const char *file)
+{
+    const std::string path = std::filesystem::path(file).lexically_normal().string();
+    const auto loaded = paths.find(path);
+    if (loaded != paths.end())
+    {
+        return &sounds.at(loaded->second);
+    }
+    const std::string name = std::filesystem::path(file).stem().string();
+    if (sounds.count(name))
+    {
+        TraceLog(
+                rl::LOG_WARNING,
+                rl::TextFormat(
+                        "SoundBank already has a sound %s, skipping %s", name.c_str(), file));
+        return nullptr;
+    }
+    LoadFiles({path}, {name});
+    const auto sound = sounds.find(name);
+    return sound == sounds.end() ? nullptr : &sound->second;
+}
+
+bool rg::mixer::SoundBank::has(const std::string &name) const
+{
+    return sounds.count(name);
+}
+
+bool rg::mixer::SoundBank::IsDecoded(const std::string &name) const
+{
+    const auto sound = sounds.find(name);
+    return sound != sounds.end() && sound->second.compressed.empty();
+}
+
+std::vector<std::string> rg::mixer::SoundBank::Names() const
+{
+    std::vector<std::string> result;
+    for (const auto &[name, sound]: sounds)
+    {
+        result.push_back(name);
+    }
+    return result;
+}
+
+unsigned int rg::mixer::SoundBank::size() const
+{
+    return sounds.size();
+}
+
+void rg::mixer::SoundBank::LoadFiles(
+        const std::vector<std::string> &files, const std::vector<std::string> &names)
+{
+    // each file is either decoded into waves or kept as it is in compressed
+    std::vector<rl::Wave> waves(files.size(), rl::Wave{});
+    std::vector<std::vector<unsigned char>> compressed(files.size());
+
+    std::atomic<size_t> next{0};
+    const auto load = [this, &files, &waves, &compressed, &next]()
+    {
+        for (size_t i = next++; i < files.size(); i = next++)
+        {
+            int size = 0;
+            unsigned char *data = rl::LoadFileData(files[i].c_str(), &size);
+            if (!data)
+            {
+                continue;
+            }
+            const char *extension = rl::GetFileExtension(files[i].c_str());
+            if (size > lazy_size && std::strcmp(extension, ".wav") != 0)
+            {
+                compressed[i].assign(data, data + size);
+            }
+            else
+            {
+                waves[i] = rl::LoadWaveFromMemory(extension, data, size);
+            }
+            rl::UnloadFileData(data);
+        }
+    };
+    const size_t count = std::min<size_t>(std::thread::hardware_concurrency(), files.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i)
+    {
+        workers.emplace_back(load);
+    }
+    // this thread works too
+    load();
+    for (auto &worker: workers)
+    {
+        worker.join();
+    }
+
+    // audio buffers are created in this thread
+    Sound::InitAudio();
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (compressed[i].empty() && !waves[i].data)
+        {
+            TraceLog(rl::LOG_WARNING, rl::TextFormat("Could not load sound %s", files[i].c_str()));
+            continue;
+        }
+        Sound &sound = sounds[names[i]];
+        sound.file = files[i];
+        if (waves[i].data)
+        {
+            sound.audio = std::make_shared<rl::Sound>(LoadSoundFromWave(waves[i]));
+            UnloadWave(waves[i]);
+        }
+        else
+        {
+            sound.audio = std::make_shared<rl::Sound>();
+            sound.compressed = std::move(compressed[i]);
+        }
+        paths[std::filesystem::path(files[i]).lexically_normal().string()] = names[i];
+    }
+}
@@ -0,0 +1,115 @@
+#include "rygame.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+rg::collision::SpatialGrid::SpatialGrid(const float cell_size)
+    : cell_size(cell_size > 0.0f ? cell_size : 64.0f)
+{}
+
+void rg::collision::SpatialGrid::Build(const std::vector<Rect> &rects)
+{
+    Clear();
+    for (unsigned int i = 0; i < rects.size(); ++i)
+    {
+        Insert(i, rects[i]);
+    }
+}
+
+void rg::collision::SpatialGrid::Build(const std::vector<sprite::Sprite_Ptr> &sprites)
+{
+    Clear();
+    for (unsigned int i = 0; i < sprites.size(); ++i)
+    {
+        Insert(i, sprites[i]->rect);
+    }
+}
+
+void rg::collision::SpatialGrid::Insert(const unsigned int id, const Rect &rect)
+{
+    const int x0 = (int) std::floor(rect.x / cell_size);
+    const int y0 = (int) std::floor(rect.y / cell_size);
+    const int x1 = (int) std::floor((rect.x + rect.width) / cell_size);
+    const int y1 = (int) std::floor((rect.y + rect.height) / cell_size);
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+            cells[Key(cx, cy)].push_back(id);
+        }
+    }
+
+    if (!has_items)
+    {
+        bounds = rect;
+        has_items = true;
+        return;
+    }
+    const float right = std::max(bounds.right(), rect.right());
+    const float bottom = std::max(bounds.bottom(), rect.bottom());
+    bounds.x = std::min(bounds.x, rect.x);
+    bounds.y = std::min(bounds.y, rect.y);
+    bounds.width = right - bounds.x;
+    bounds.height = bottom - bounds.y;
+}
+
+void rg::collision::SpatialGrid::Clear()
+{
+    cells.clear();
+    bounds = {};
+    has_items = false;
+}
+
+std::vector<unsigned int> rg::collision::SpatialGrid::Query(const Rect &area) const
+{
+    std::vector<unsigned int> result;
+    const int x0 = (int) std::floor(area.x / cell_size);
+    const int y0 = (int) std::floor(area.y / cell_size);
+    const int x1 = (int) std::floor((area.x + area.width) / cell_size);
+    const int y1 = (int) std::floor((area.y + area.height) / cell_size);
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+            const auto *ids = Cell(cx, cy);
+            if (!ids)
+            {
+                continue;
+            }
+            result.insert(result.end(), ids->begin(), ids->end());
+        }
+    }
+    // an item is in a cell once, only items spanning several cells can repeat
+    if (x0 != x1 || y0 != y1)
+    {
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+    return result;
+}
+
+const std::vector<unsigned int> *
+rg::collision::SpatialGrid::Cell(const int cell_x, const int cell_y) const
+{
+    const auto it = cells.find(Key(cell_x, cell_y));
+    if (it == cells.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+float rg::collision::SpatialGrid::GetCellSize() const
+{
+    return cell_size;
+}
+
+rg::Rect rg::collision::SpatialGrid::GetBounds() const
+{
+    return bounds;
+}
+
+int64_t rg::collision::SpatialGrid::Key(const int cell_x, const int cell_y)
+{
+    return (int64_t) cell_x << 32 | (uint32_t) cell_y;
+}
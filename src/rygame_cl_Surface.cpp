@@ -27,6 +27,12 @@ rg::Surface::Surface(rl::Texture2D *texture, const Rect atlas)
     }
 }
 
+rg::Surface::Surface(const Surface_Ptr &parent_surface, const Rect rect)
+    : render(parent_surface->render), atlas_rect(rect),
+      shared_texture(parent_surface->shared_texture), parent(parent_surface), offset(rect.pos),
+      draw_count(parent_surface->draw_count)
+{}
+
 rg::Surface::~Surface()
 {
     if (render.id && !parent)
@@ -197,14 +203,7 @@ rg::Rect rg::Surface::GetRect() const
 
 rg::Surface_Ptr rg::Surface::SubSurface(const Rect rect)
 {
-    auto result = std::make_shared<Surface>(GetTexture().width, GetTexture().height);
-    UnloadRenderTextureSafe(result->render);
-    result->render = render;
-    result->shared_texture = shared_texture;
-    result->atlas_rect = rect;
-    result->parent = shared_from_this();
-    result->offset = rect.pos;
-    return result;
+    return std::make_shared<Surface>(shared_from_this(), rect);
 }
 
 rg::Surface_Ptr rg::Surface::GetParent()
@@ -231,10 +230,25 @@ rl::Texture2D rg::Surface::GetTexture() const
     return render.texture;
 }
 
+rg::Rect rg::Surface::GetSourceRect() const
+{
+    // Blit draws with -height, see Surface::Blit(Texture2D)
+    return {atlas_rect.x, atlas_rect.y, atlas_rect.width,
+            -atlas_rect.height * flip_atlas_height};
+}
+
 void rg::Surface::ToggleRender()
 {
+    // anything can be drawn after this, masks of this render and its views must be recreated
+    ++*draw_count;
     if (rygame.current_render != render.id)
     {
+        // reading a texture for a mask ends the render, so its alpha can only be cached
+        // while this isn't the current render
+        if (render.texture.id)
+        {
+            mask::ClearCache(render.texture.id);
+        }
         EndTextureModeSafe();
         TraceLog(
                 rl::LOG_TRACE,
@@ -244,6 +258,16 @@ void rg::Surface::ToggleRender()
     }
 }
 
+std::shared_ptr<rg::mask::Mask> rg::Surface::GetMask()
+{
+    if (cached_masks.empty() || masks_draw_count != *draw_count)
+    {
+        cached_masks = {std::make_shared<mask::Mask>(mask::FromSurface(shared_from_this()))};
+        masks_draw_count = *draw_count;
+    }
+    return cached_masks[0];
+}
+
 void rg::Surface::Setup(const int width, const int height)
 {
     if (!render.id)
@@ -0,0 +1,144 @@
+#include "rygame.hpp"
+
+
+rg::font::TextLayout::TextLayout(
+        const Font &font, const char *text, const float max_width, const TextAlign align,
+        const float spacing, const float line_spacing, const float text_size)
+    : font(&font), spacing(spacing)
+{
+    const float drawSize = text_size > 0 ? text_size : font.font_size;
+    scale = drawSize / (float) font.font.baseSize;
+    line_height = drawSize + line_spacing;
+    const float space = font.WordAdvance(" ").first * scale + spacing;
+
+    float pen = 0;
+    std::vector<Glyph> pending; // glyphs of the current line
+    std::string word;
+    const char *c = text;
+    while (true)
+    {
+        if (*c && *c != ' ' && *c != '\n')
+        {
+            word.push_back(*c++);
+            continue;
+        }
+        // a word ended, at a space, a new line or the text end
+        const auto [advance, count] = font.WordAdvance(word);
+        const float width = count ? advance * scale + (float) (count - 1) * spacing : 0;
+        if (max_width > 0 && pen > 0 && pen + width > max_width)
+        {
+            // the space before the word is dropped at the wrap
+            EndLine(pen - space - spacing, &pending);
+            pen = 0;
+        }
+        AddWord(word, &pen, &pending);
+        // words longer than max_width are broken at any glyph
+        if (max_width > 0 && pen - spacing > max_width && count > 1)
+        {
+            pending.resize(pending.size() - count);
+            pen -= width + spacing;
+            int codepointSize = 0;
+            for (const char *w = word.c_str(); *w; w += codepointSize)
+            {
+                rl::GetCodepointNext(w, &codepointSize);
+                const std::string glyph(w, codepointSize);
+                const float glyph_width = font.WordAdvance(glyph).first * scale;
+                if (pen > 0 && pen + glyph_width > max_width)
+                {
+                    EndLine(pen - spacing, &pending);
+                    pen = 0;
+                }
+                AddWord(glyph, &pen, &pending);
+            }
+        }
+        word.clear();
+        if (!*c)
+        {
+            break;
+        }
+        if (*c == '\n')
+        {
+            EndLine(pen > 0 ? pen - spacing : 0, &pending);
+            pen = 0;
+        }
+        else
+        {
+            pen += space;
+        }
+        ++c;
+    }
+    EndLine(pen > 0 ? pen - spacing : 0, &pending);
+
+    size.x = max_width > 0 ? max_width : 0;
+    for (const Line &line: lines)
+    {
+        size.x = std::max(size.x, line.width);
+    }
+    size.y = lines.empty() ? 0 : (float) lines.size() * line_height - line_spacing;
+    if (align == ALIGN_LEFT)
+    {
+        return;
+    }
+    for (const Line &line: lines)
+    {
+        const float offset = align == ALIGN_CENTER ? (size.x - line.width) / 2.0f
+                                                   : size.x - line.width;
+        for (unsigned int i = 0; i < line.glyph_count; ++i)
+        {
+            glyphs[line.first_glyph + i].dest.x += offset;
+        }
+    }
+}
+
+void rg::font::TextLayout::Draw(
+        const Surface_Ptr &surface, const math::Vector2 position, const rl::Color color) const
+{
+    surface->ToggleRender();
+    font->BeginDraw();
+    for (const Glyph &glyph: glyphs)
+    {
+        const Rect dest = {
+                glyph.dest.x + position.x, glyph.dest.y + position.y, glyph.dest.width,
+                glyph.dest.height};
+        DrawTexturePro(
+                font->font.texture, glyph.source.rectangle, dest.rectangle, {0, 0}, 0, color);
+    }
+    font->EndDraw();
+}
+
+rg::math::Vector2 rg::font::TextLayout::GetSize() const
+{
+    return size;
+}
+
+void rg::font::TextLayout::AddWord(
+        const std::string &word, float *pen, std::vector<Glyph> *pending)
+{
+    const rl::Font &raylib_font = font->font;
+    const float padding = (float) raylib_font.glyphPadding;
+    const float top = (float) lines.size() * line_height;
+    int codepointSize = 0;
+    for (const char *c = word.c_str(); *c; c += codepointSize)
+    {
+        const int index = font->GlyphIndex(rl::GetCodepointNext(c, &codepointSize));
+        const rl::GlyphInfo &info = raylib_font.glyphs[index];
+        const rl::Rectangle &rec = raylib_font.recs[index];
+        // same quad as DrawTextCodepoint
+        Glyph glyph;
+        glyph.source = {rec.x - padding, rec.y - padding, rec.width + 2.0f * padding,
+                        rec.height + 2.0f * padding};
+        glyph.dest = {*pen + ((float) info.offsetX - padding) * scale,
+                      top + ((float) info.offsetY - padding) * scale,
+                      glyph.source.width * scale, glyph.source.height * scale};
+        pending->push_back(glyph);
+        const float advance = info.advanceX ? (float) info.advanceX : rec.width;
+        *pen += advance * scale + spacing;
+    }
+}
+
+void rg::font::TextLayout::EndLine(const float pen, std::vector<Glyph> *pending)
+{
+    lines.push_back({(unsigned int) glyphs.size(), (unsigned int) pending->size(), pen});
+    glyphs.insert(glyphs.end(), pending->begin(), pending->end());
+    pending->clear();
+}
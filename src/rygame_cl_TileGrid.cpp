@@ -0,0 +1,152 @@
+#include "rygame.hpp"
+#include "rygame_bits.hpp"
+#include <cmath>
+
+
+// Calls `visit(x, y)` for each set bit of `mask` in [x0, x1] x [y0, y1] until it returns true.
+// Skips empty words.
+template<typename Visit>
+static void ForEachSet(
+        const rg::mask::Mask &mask, const int x0, const int y0, const int x1, const int y1,
+        Visit visit)
+{
+    const int first_word = x0 / 64;
+    const int last_word = x1 / 64;
+    for (int y = y0; y <= y1; ++y)
+    {
+        const uint64_t *row = mask.Row(y);
+        for (int w = first_word; w <= last_word; ++w)
+        {
+            uint64_t word = row[w];
+            if (w == first_word)
+            {
+                word &= ~uint64_t{0} << (x0 % 64);
+            }
+            if (w == last_word && x1 % 64 != 63)
+            {
+                word &= (uint64_t{1} << (x1 % 64 + 1)) - 1;
+            }
+            while (word)
+            {
+                if (visit(w * 64 + (int) FirstBit(word), y))
+                {
+                    return;
+                }
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+rg::collision::TileGrid::TileGrid(
+        const unsigned int width, const unsigned int height, const math::Vector2 tile_size)
+    : tiles(width, height), tile_size(tile_size)
+{}
+
+#ifdef WITH_TMX
+rg::collision::TileGrid::TileGrid(const rl::tmx_map *map, const rl::tmx_layer *layer)
+    : tiles(map->width, map->height),
+      tile_size{(float) map->tile_width, (float) map->tile_height}
+{
+    if (layer->type != rl::L_LAYER)
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("TileGrid layer %s has no tiles", layer->name));
+        return;
+    }
+    position = {(float) layer->offsetx, (float) layer->offsety};
+    const int32_t *gids = layer->content.gids;
+    for (unsigned int y = 0; y < map->height; y++)
+    {
+        for (unsigned int x = 0; x < map->width; x++)
+        {
+            const unsigned int gid = gids[y * map->width + x] & TMX_FLIP_BITS_REMOVAL;
+            if (map->tiles[gid])
+            {
+                tiles.set_at((int) x, (int) y);
+            }
+        }
+    }
+}
+#endif
+
+bool rg::collision::TileGrid::get_at(const int x, const int y) const
+{
+    return tiles.get_at(x, y);
+}
+
+void rg::collision::TileGrid::set_at(const int x, const int y, const bool solid)
+{
+    tiles.set_at(x, y, solid);
+}
+
+bool rg::collision::TileGrid::collide(const Rect &rect) const
+{
+    int x0, y0, x1, y1;
+    if (!TileRange(rect, &x0, &y0, &x1, &y1))
+    {
+        return false;
+    }
+    bool result = false;
+    ForEachSet(
+            tiles, x0, y0, x1, y1,
+            [&result](int, int)
+            {
+                result = true;
+                return true;
+            });
+    return result;
+}
+
+std::vector<rg::Rect> rg::collision::TileGrid::GetRects(const Rect &area) const
+{
+    std::vector<Rect> result;
+    int x0, y0, x1, y1;
+    if (!TileRange(area, &x0, &y0, &x1, &y1))
+    {
+        return result;
+    }
+    ForEachSet(
+            tiles, x0, y0, x1, y1,
+            [this, &result](const int x, const int y)
+            {
+                result.push_back(GetTileRect(x, y));
+                return false;
+            });
+    return result;
+}
+
+rg::Rect rg::collision::TileGrid::GetTileRect(const int x, const int y) const
+{
+    return {position.x + (float) x * tile_size.x, position.y + (float) y * tile_size.y,
+            tile_size.x, tile_size.y};
+}
+
+rg::math::Vector2 rg::collision::TileGrid::get_size() const
+{
+    return tiles.get_size();
+}
+
+rg::math::Vector2 rg::collision::TileGrid::GetTileSize() const
+{
+    return tile_size;
+}
+
+bool rg::collision::TileGrid::TileRange(
+        const Rect &area, int *x0, int *y0, int *x1, int *y1) const
+{
+    if (tile_size.x <= 0 || tile_size.y <= 0)
+    {
+        return false;
+    }
+    const math::Vector2 size = tiles.get_size();
+    // tiles only touching the area edges don't overlap it
+    const float left = std::max((area.x - position.x) / tile_size.x, 0.0f);
+    const float top = std::max((area.y - position.y) / tile_size.y, 0.0f);
+    const float right = std::min((area.x + area.width - position.x) / tile_size.x, size.x);
+    const float bottom = std::min((area.y + area.height - position.y) / tile_size.y, size.y);
+    *x0 = (int) std::floor(left);
+    *y0 = (int) std::floor(top);
+    *x1 = (int) std::ceil(right) - 1;
+    *y1 = (int) std::ceil(bottom) - 1;
+    return *x0 <= *x1 && *y0 <= *y1;
+}
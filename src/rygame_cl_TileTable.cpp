@@ -0,0 +1,38 @@
+#include "rygame.hpp"
+
+
+#ifdef WITH_TMX
+rg::tmx::TileTable::TileTable(const rl::tmx_map *map) : entries(map->tilecount)
+{
+    for (unsigned int gid = 0; gid < map->tilecount; ++gid)
+    {
+        const rl::tmx_tile *tile = map->tiles[gid];
+        if (!tile)
+        {
+            continue;
+        }
+        Entry &entry = entries[gid];
+        entry.texture = GetTMXTileTexture(tile, &entry.atlas_rect);
+        entry.tile_size = {(float) tile->tileset->tile_width, (float) tile->tileset->tile_height};
+    }
+}
+
+const rg::tmx::TileTable::Entry *rg::tmx::TileTable::Get(const uint32_t gid) const
+{
+    if (gid >= entries.size() || !entries[gid].texture)
+    {
+        return nullptr;
+    }
+    return &entries[gid];
+}
+
+rg::math::Vector2 rg::tmx::TileTable::GetPosition(const TileRef &tile) const
+{
+    const Entry *entry = Get(tile.gid);
+    if (!entry)
+    {
+        return {};
+    }
+    return {(float) tile.x * entry->tile_size.x, (float) tile.y * entry->tile_size.y};
+}
+#endif // WITH_TMX
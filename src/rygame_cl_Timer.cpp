@@ -13,15 +13,47 @@ rg::Timer::Timer(
     }
 }
 
+rg::Timer::Timer(const Timer &other)
+    : active(other.active), duration(other.duration), repeat(other.repeat),
+      autostart(other.autostart), func(other.func), start_time(other.start_time)
+{}
+
+rg::Timer &rg::Timer::operator=(const Timer &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    CancelEnd();
+    active = other.active;
+    duration = other.duration;
+    repeat = other.repeat;
+    autostart = other.autostart;
+    func = other.func;
+    start_time = other.start_time;
+    if (active)
+    {
+        ScheduleEnd(duration - (float) (rl::GetTime() - start_time));
+    }
+    return *this;
+}
+
+rg::Timer::~Timer()
+{
+    CancelEnd();
+}
+
 void rg::Timer::Activate()
 {
     active = true;
     start_time = rl::GetTime();
+    ScheduleEnd(duration);
 }
 
 void rg::Timer::Deactivate()
 {
     active = false;
+    CancelEnd();
     start_time = rl::GetTime();
     if (repeat)
     {
@@ -31,17 +63,64 @@ void rg::Timer::Deactivate()
 
 void rg::Timer::Update()
 {
-    if (!active)
+    if (!active || scheduler)
     {
         return;
     }
     const double currentTime = rl::GetTime();
     if (currentTime - start_time >= duration)
     {
-        Deactivate();
-        if (func)
-        {
-            func();
-        }
+        End();
+    }
+}
+
+void rg::Timer::Register(time::Scheduler &scheduler)
+{
+    CancelEnd();
+    this->scheduler = &scheduler;
+    if (active)
+    {
+        ScheduleEnd(duration - (float) (rl::GetTime() - start_time));
+    }
+}
+
+void rg::Timer::Unregister()
+{
+    CancelEnd();
+    scheduler = nullptr;
+}
+
+void rg::Timer::ScheduleEnd(const float delay)
+{
+    if (!scheduler)
+    {
+        return;
+    }
+    CancelEnd();
+    scheduled = scheduler->Schedule(
+            delay,
+            [this]()
+            {
+                // the scheduler already removed it
+                scheduled = 0;
+                End();
+            });
+}
+
+void rg::Timer::CancelEnd()
+{
+    if (scheduler && scheduled)
+    {
+        scheduler->Cancel(scheduled);
+    }
+    scheduled = 0;
+}
+
+void rg::Timer::End()
+{
+    Deactivate();
+    if (func)
+    {
+        func();
     }
 }
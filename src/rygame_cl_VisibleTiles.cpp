@@ -0,0 +1,96 @@
+#include "rygame.hpp"
+#include <cmath>
+
+
+#ifdef WITH_TMX
+rg::tmx::VisibleTiles::VisibleTiles(
+        const rl::tmx_map *map, const rl::tmx_layer *layer, const Rect &area)
+    : map(map), layer(layer)
+{
+    if (layer->type != rl::L_LAYER || !map->tile_width || !map->tile_height)
+    {
+        return;
+    }
+    const float tile_width = (float) map->tile_width;
+    const float tile_height = (float) map->tile_height;
+    // one extra cell before, tiles bigger than the map grid can overflow into area
+    x0 = (int) std::floor(std::max(area.x / tile_width - 1.0f, 0.0f));
+    y0 = (int) std::floor(std::max(area.y / tile_height - 1.0f, 0.0f));
+    x1 = (int) std::ceil(std::min((area.x + area.width) / tile_width, (float) map->width)) - 1;
+    y1 = (int) std::ceil(std::min((area.y + area.height) / tile_height, (float) map->height)) -
+         1;
+    if (x0 > x1 || y0 > y1)
+    {
+        x1 = y1 = -1;
+        x0 = y0 = 0;
+    }
+}
+
+rg::tmx::VisibleTiles::iterator rg::tmx::VisibleTiles::begin() const
+{
+    iterator it(this, x0, y0);
+    it.SkipEmpty();
+    return it;
+}
+
+rg::tmx::VisibleTiles::iterator rg::tmx::VisibleTiles::end() const
+{
+    // the cell after the last row
+    return {this, x0, y1 + 1};
+}
+
+rg::tmx::VisibleTiles::iterator::iterator(const VisibleTiles *range, const int x, const int y)
+    : range(range), x(x), y(y)
+{}
+
+rg::tmx::VisibleTiles::iterator::reference rg::tmx::VisibleTiles::iterator::operator*() const
+{
+    return current;
+}
+
+rg::tmx::VisibleTiles::iterator::pointer rg::tmx::VisibleTiles::iterator::operator->() const
+{
+    return &current;
+}
+
+rg::tmx::VisibleTiles::iterator &rg::tmx::VisibleTiles::iterator::operator++()
+{
+    if (++x > range->x1)
+    {
+        x = range->x0;
+        ++y;
+    }
+    SkipEmpty();
+    return *this;
+}
+
+bool rg::tmx::VisibleTiles::iterator::operator==(const iterator &other) const
+{
+    return range == other.range && x == other.x && y == other.y;
+}
+
+bool rg::tmx::VisibleTiles::iterator::operator!=(const iterator &other) const
+{
+    return !(*this == other);
+}
+
+void rg::tmx::VisibleTiles::iterator::SkipEmpty()
+{
+    const rl::tmx_map *map = range->map;
+    const int32_t *gids = range->layer->content.gids;
+    for (; y <= range->y1; ++y, x = range->x0)
+    {
+        for (; x <= range->x1; ++x)
+        {
+            const unsigned int gid = gids[y * map->width + x] & TMX_FLIP_BITS_REMOVAL;
+            if (map->tiles[gid])
+            {
+                current = {(uint16_t) x, (uint16_t) y, gid};
+                return;
+            }
+        }
+    }
+    // end()
+    x = range->x0;
+}
+#endif // WITH_TMX
@@ -0,0 +1,354 @@
+#include "rygame.hpp"
+#include <cmath>
+#include <limits>
+
+
+// Distances along the ray (origin + t * direction) where it enters and exits `rect`.
+// Returns false if the ray doesn't cross it between [0, max_t]
+static bool RayRect(
+        const rg::math::Vector2 origin, const rg::math::Vector2 direction, const rg::Rect &rect,
+        const float max_t, float *t_enter, float *t_exit)
+{
+    float t0 = 0.0f, t1 = max_t;
+    for (unsigned int axis = 0; axis < 2; ++axis)
+    {
+        const float o = origin[axis];
+        const float d = direction[axis];
+        const float low = axis ? rect.y : rect.x;
+        const float high = low + (axis ? rect.height : rect.width);
+        if (d == 0.0f)
+        {
+            if (o < low || o > high)
+            {
+                return false;
+            }
+            continue;
+        }
+        float ta = (low - o) / d;
+        float tb = (high - o) / d;
+        if (ta > tb)
+        {
+            std::swap(ta, tb);
+        }
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if (t0 > t1)
+        {
+            return false;
+        }
+    }
+    *t_enter = t0;
+    *t_exit = t1;
+    return true;
+}
+
+// Walks the grid cells (cell_size x cell_size) crossed by the ray between t_begin and t_end
+// (Amanatides-Woo DDA). `visit(cell_x, cell_y, t_enter, t_exit)` returns true to stop.
+template<typename Visit>
+static void WalkCells(
+        const rg::math::Vector2 origin, const rg::math::Vector2 direction, const float cell_size,
+        const float t_begin, const float t_end, Visit visit)
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    const rg::math::Vector2 start = origin + direction * t_begin;
+    int cx = (int) std::floor(start.x / cell_size);
+    int cy = (int) std::floor(start.y / cell_size);
+    const int step_x = direction.x > 0 ? 1 : direction.x < 0 ? -1 : 0;
+    const int step_y = direction.y > 0 ? 1 : direction.y < 0 ? -1 : 0;
+    float t_max_x = step_x ? ((cx + (step_x > 0)) * cell_size - origin.x) / direction.x : inf;
+    float t_max_y = step_y ? ((cy + (step_y > 0)) * cell_size - origin.y) / direction.y : inf;
+    const float t_delta_x = step_x ? cell_size / std::fabs(direction.x) : inf;
+    const float t_delta_y = step_y ? cell_size / std::fabs(direction.y) : inf;
+    float t = t_begin;
+    while (t <= t_end)
+    {
+        const float t_next = std::min(t_max_x, t_max_y);
+        if (visit(cx, cy, t, std::min(t_next, t_end)))
+        {
+            return;
+        }
+        t = t_next;
+        if (t_max_x < t_max_y)
+        {
+            cx += step_x;
+            t_max_x += t_delta_x;
+        }
+        else
+        {
+            cy += step_y;
+            t_max_y += t_delta_y;
+        }
+    }
+}
+
+std::vector<rg::collision::RayHit> rg::collision::Raycast(
+        const std::vector<Ray> &rays, const std::vector<Rect> &rects, const SpatialGrid &grid)
+{
+    std::vector<RayHit> hits(rays.size());
+    // rects already tested by the current ray
+    std::vector<unsigned int> tested(rects.size(), 0);
+    const Rect bounds = grid.GetBounds();
+    for (unsigned int r = 0; r < rays.size(); ++r)
+    {
+        const Ray &ray = rays[r];
+        const math::Vector2 direction = ray.direction.normalize();
+        float t_begin, t_end;
+        if (!direction ||
+            !RayRect(ray.origin, direction, bounds, ray.max_distance, &t_begin, &t_end))
+        {
+            continue;
+        }
+        RayHit &hit = hits[r];
+        float best = ray.max_distance;
+        WalkCells(
+                ray.origin, direction, grid.GetCellSize(), t_begin, t_end,
+                [&](const int cx, const int cy, float, const float t_exit)
+                {
+                    if (const auto *ids = grid.Cell(cx, cy))
+                    {
+                        for (const unsigned int id: *ids)
+                        {
+                            if (id >= rects.size() || tested[id] == r + 1)
+                            {
+                                continue;
+                            }
+                            tested[id] = r + 1;
+                            float t_enter, t_out;
+                            if (RayRect(ray.origin, direction, rects[id], best, &t_enter, &t_out) &&
+                                (!hit.hit || t_enter < best))
+                            {
+                                best = t_enter;
+                                hit.hit = true;
+                                hit.index = id;
+                            }
+                        }
+                    }
+                    // a hit inside the cells already walked can't be beaten by later cells
+                    return hit.hit && best <= t_exit;
+                });
+        if (hit.hit)
+        {
+            hit.distance = best;
+            hit.point = ray.origin + direction * best;
+        }
+    }
+    return hits;
+}
+
+std::vector<rg::collision::RayHit> rg::collision::Raycast(
+        const std::vector<Ray> &rays, const mask::Mask &mask, const math::Vector2 offset)
+{
+    std::vector<RayHit> hits(rays.size());
+    const Rect bounds = mask.get_rect();
+    for (unsigned int r = 0; r < rays.size(); ++r)
+    {
+        const Ray &ray = rays[r];
+        const math::Vector2 direction = ray.direction.normalize();
+        // mask coordinates
+        const math::Vector2 origin = ray.origin - offset;
+        float t_begin, t_end;
+        if (!direction || !RayRect(origin, direction, bounds, ray.max_distance, &t_begin, &t_end))
+        {
+            continue;
+        }
+        RayHit &hit = hits[r];
+        WalkCells(
+                origin, direction, 1.0f, t_begin, t_end,
+                [&](const int x, const int y, const float t_enter, float)
+                {
+                    if (mask.get_at(x, y))
+                    {
+                        hit.hit = true;
+                        hit.distance = t_enter;
+                        hit.point = ray.origin + direction * t_enter;
+                        return true;
+                    }
+                    return false;
+                });
+    }
+    return hits;
+}
+
+bool rg::collision::LineOfSight(
+        const math::Vector2 from, const math::Vector2 to, const mask::Mask &mask,
+        const math::Vector2 offset)
+{
+    const math::Vector2 delta = to - from;
+    return !Raycast({{from, delta, delta.magnitude()}}, mask, offset)[0].hit;
+}
+
+// Overlaps smaller than this are treated as touching, so rects placed at a contact can slide
+// along it
+static constexpr float SWEEP_SKIN = 1e-4f;
+
+rg::collision::SweepHit rg::collision::Sweep(
+        const Rect &rect, const math::Vector2 velocity, const Rect &other)
+{
+    SweepHit result;
+    result.position = rect.pos + velocity;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    float t_enter[2], t_exit[2];
+    for (unsigned int axis = 0; axis < 2; ++axis)
+    {
+        const float v = velocity[axis];
+        const float low = axis ? rect.y : rect.x;
+        const float high = low + (axis ? rect.height : rect.width);
+        const float other_low = axis ? other.y : other.x;
+        const float other_high = other_low + (axis ? other.height : other.width);
+        if (v == 0.0f)
+        {
+            if (low >= other_high - SWEEP_SKIN || high <= other_low + SWEEP_SKIN)
+            {
+                return result;
+            }
+            t_enter[axis] = -inf;
+            t_exit[axis] = inf;
+            continue;
+        }
+        // `other` is behind, or touching it, while moving away
+        if (v > 0 ? low >= other_high - SWEEP_SKIN : high <= other_low + SWEEP_SKIN)
+        {
+            return result;
+        }
+        const float near = v > 0 ? other_low - high : other_high - low;
+        const float far = v > 0 ? other_high - low : other_low - high;
+        t_enter[axis] = near / v;
+        t_exit[axis] = far / v;
+    }
+    const unsigned int axis = t_enter[0] >= t_enter[1] ? 0 : 1;
+    const float enter = t_enter[axis];
+    const float exit = std::min(t_exit[0], t_exit[1]);
+    // moving away, or the contact is after this move
+    if (enter >= exit || exit <= 0.0f || enter > 1.0f)
+    {
+        return result;
+    }
+    float normal = velocity[axis] > 0 ? -1.0f : 1.0f;
+    if (enter < 0.0f)
+    {
+        // already overlapping (rounding after a slide), the normal points from the center of
+        // `other` and moving along it is escaping
+        const float center = axis ? rect.y + rect.height / 2 : rect.x + rect.width / 2;
+        const float other_center =
+                axis ? other.y + other.height / 2 : other.x + other.width / 2;
+        normal = center < other_center ? -1.0f : 1.0f;
+        if (velocity[axis] * normal >= 0.0f)
+        {
+            return result;
+        }
+    }
+    result.hit = true;
+    result.time = std::max(enter, 0.0f);
+    (axis ? result.normal.y : result.normal.x) = normal;
+    result.position = rect.pos + velocity * result.time;
+    return result;
+}
+
+// Area covered by `rect` while moving by `velocity`
+static rg::Rect SweptArea(const rg::Rect &rect, const rg::math::Vector2 velocity)
+{
+    return {std::min(rect.x, rect.x + velocity.x), std::min(rect.y, rect.y + velocity.y),
+            rect.width + std::fabs(velocity.x), rect.height + std::fabs(velocity.y)};
+}
+
+// Moves `rect` by `velocity` with `sweep(rect, velocity)`, keeping the remaining movement
+// along each contact
+template<typename SweepFunc>
+static rg::collision::SweepHit SlideWith(
+        rg::Rect &rect, rg::math::Vector2 velocity, const int max_slides, SweepFunc sweep)
+{
+    rg::collision::SweepHit first;
+    for (int i = 0; i < max_slides && velocity; ++i)
+    {
+        const rg::collision::SweepHit hit = sweep(rect, velocity);
+        rect.pos = hit.position;
+        if (!hit.hit)
+        {
+            return first;
+        }
+        if (!first.hit)
+        {
+            first = hit;
+        }
+        velocity = velocity * (1.0f - hit.time);
+        if (hit.normal.x != 0.0f)
+        {
+            velocity.x = 0.0f;
+        }
+        else
+        {
+            velocity.y = 0.0f;
+        }
+    }
+    return first;
+}
+
+rg::collision::SweepHit rg::collision::Sweep(
+        const Rect &rect, const math::Vector2 velocity, const std::vector<Rect> &rects,
+        const SpatialGrid &grid)
+{
+    SweepHit result;
+    result.position = rect.pos + velocity;
+    if (!velocity)
+    {
+        return result;
+    }
+    const Rect area = SweptArea(rect, velocity);
+    for (const unsigned int id: grid.Query(area))
+    {
+        if (id >= rects.size())
+        {
+            continue;
+        }
+        const SweepHit hit = Sweep(rect, velocity, rects[id]);
+        if (hit.hit && (!result.hit || hit.time < result.time))
+        {
+            result = hit;
+            result.index = id;
+        }
+    }
+    return result;
+}
+
+rg::collision::SweepHit rg::collision::Slide(
+        Rect &rect, const math::Vector2 velocity, const std::vector<Rect> &rects,
+        const SpatialGrid &grid, const int max_slides)
+{
+    return SlideWith(
+            rect, velocity, max_slides,
+            [&rects, &grid](const Rect &moving, const math::Vector2 remaining)
+            { return Sweep(moving, remaining, rects, grid); });
+}
+
+rg::collision::SweepHit rg::collision::Sweep(
+        const Rect &rect, const math::Vector2 velocity, const TileGrid &tiles)
+{
+    SweepHit result;
+    result.position = rect.pos + velocity;
+    if (!velocity)
+    {
+        return result;
+    }
+    for (const Rect &tile: tiles.GetRects(SweptArea(rect, velocity)))
+    {
+        const SweepHit hit = Sweep(rect, velocity, tile);
+        if (hit.hit && (!result.hit || hit.time < result.time))
+        {
+            result = hit;
+            const math::Vector2 tile_size = tiles.GetTileSize();
+            const int x = (int) std::lround((tile.x - tiles.position.x) / tile_size.x);
+            const int y = (int) std::lround((tile.y - tiles.position.y) / tile_size.y);
+            result.index = y * (int) tiles.get_size().x + x;
+        }
+    }
+    return result;
+}
+
+rg::collision::SweepHit rg::collision::Slide(
+        Rect &rect, const math::Vector2 velocity, const TileGrid &tiles, const int max_slides)
+{
+    return SlideWith(
+            rect, velocity, max_slides,
+            [&tiles](const Rect &moving, const math::Vector2 remaining)
+            { return Sweep(moving, remaining, tiles); });
+}
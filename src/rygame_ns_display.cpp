@@ -24,10 +24,7 @@ rg::Surface_Ptr rg::display::GetSurface()
 
 void rg::display::Update()
 {
-    for (const auto &music: rygame.musics)
-    {
-        UpdateMusicStream(*(rl::Music *) music->audio.get());
-    }
+    mixer::Update();
 
     EndTextureModeSafe();
     // RenderTexture renders things flipped in Y axis, we draw it "unflipped"
@@ -1,47 +1,252 @@
 #include "rygame.hpp"
+#include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RYGAME_SSE2
+#endif
 
 
-rg::mask::Mask
-rg::mask::FromSurface(const Surface_Ptr &surface, const unsigned char threshold)
+// Alpha channel of a texture, read from the GPU once and reused until the texture is drawn
+// into (see ClearCache)
+struct AlphaData
+{
+    int width;
+    int height;
+    std::vector<unsigned char> alpha;
+};
+
+static std::unordered_map<unsigned int, AlphaData> alpha_cache;
+
+// Returns a GRAYSCALE image (alpha channel) of texture, reading it only if it isn't cached.
+// The image data belongs to the cache, don't unload it.
+static rl::Image GetTextureAlpha(const rl::Texture2D &texture)
 {
-    auto mask = Mask(surface->GetRect().width, surface->GetRect().height);
-    const rl::Image surfImage = LoadImageFromTextureSafe(surface->GetTexture());
-    const rl::Image alphaImage = ImageFromChannel(surfImage, 3);
-    const auto alphaData = (unsigned char *) alphaImage.data;
-    const auto maskData = (unsigned char *) mask.image.data;
-    for (int i = 0; i < mask.image.width * mask.image.height; i++)
+    auto it = alpha_cache.find(texture.id);
+    if (it == alpha_cache.end())
     {
-        if (alphaData[i] > threshold)
+        rl::Image image = rg::LoadImageFromTextureSafe(texture);
+        ImageFormat(&image, rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        AlphaData data{image.width, image.height, {}};
+        data.alpha.resize(image.width * image.height);
+        const auto *pixels = (const unsigned char *) image.data;
+        for (size_t i = 0; i < data.alpha.size(); ++i)
         {
-            maskData[i] = 255;
+            data.alpha[i] = pixels[i * 4 + 3];
         }
+        UnloadImage(image);
+        it = alpha_cache.emplace(texture.id, std::move(data)).first;
     }
-    mask.atlas_rect = surface->atlas_rect;
+    rl::Image result{};
+    result.data = it->second.alpha.data();
+    result.width = it->second.width;
+    result.height = it->second.height;
+    result.mipmaps = 1;
+    result.format = rl::PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+    return result;
+}
+
+#ifdef RYGAME_SSE2
+// 16 alpha values > threshold as 16 bits. `pixels` is GRAYSCALE (stride 1) or RGBA (stride 4)
+static uint64_t CompareAlpha16(const unsigned char *pixels, const int stride, const __m128i min)
+{
+    __m128i alpha;
+    if (stride == 1)
+    {
+        alpha = _mm_loadu_si128((const __m128i *) pixels);
+    }
+    else
+    {
+        // move alpha to the low byte of each pixel, then pack 16 pixels into 16 bytes
+        const __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *) pixels), 24);
+        const __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *) (pixels + 16)), 24);
+        const __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *) (pixels + 32)), 24);
+        const __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *) (pixels + 48)), 24);
+        alpha = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+    }
+    // unsigned alpha >= min
+    const __m128i greater = _mm_cmpeq_epi8(_mm_max_epu8(alpha, min), alpha);
+    return (uint64_t) (unsigned int) _mm_movemask_epi8(greater);
+}
+
+// 4 RGBA pixels where every channel is |pixel - color| <= max_diff, as 4 bits
+static unsigned int CompareColor4(
+        const unsigned char *pixels, const __m128i color, const __m128i max_diff)
+{
+    const __m128i v = _mm_loadu_si128((const __m128i *) pixels);
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, color), _mm_subs_epu8(color, v));
+    const __m128i inside = _mm_cmpeq_epi8(_mm_min_epu8(diff, max_diff), diff);
+    const __m128i all = _mm_cmpeq_epi32(inside, _mm_set1_epi32(-1));
+    return _mm_movemask_ps(_mm_castsi128_ps(all));
+}
+#endif
 
-    UnloadImage(alphaImage);
-    UnloadImage(surfImage);
+
+rg::mask::Mask
+rg::mask::FromSurface(const Surface_Ptr &surface, const unsigned char threshold)
+{
+    const rl::Image alphaImage = GetTextureAlpha(surface->GetTexture());
+    auto mask = FromImage(alphaImage, surface->GetSourceRect(), threshold);
+    mask.atlas_rect = surface->atlas_rect;
     return mask;
 }
 
 rg::mask::Mask
 rg::mask::FromSurface(const Frames_Ptr &frames, const unsigned char threshold)
 {
-    auto mask = Mask(frames->render.texture.width, frames->render.texture.height);
-    const rl::Image surfImage = LoadImageFromTextureSafe(frames->render.texture);
-    const rl::Image alphaImage = ImageFromChannel(surfImage, 3);
-    const auto alphaData = (unsigned char *) alphaImage.data;
-    const auto maskData = (unsigned char *) mask.image.data;
-    for (int i = 0; i < mask.image.width * mask.image.height; i++)
+    const rl::Image alphaImage = GetTextureAlpha(frames->render.texture);
+    // Frames render is not flipped
+    return FromImage(alphaImage, {}, threshold);
+}
+
+rg::mask::Mask
+rg::mask::FromImage(const rl::Image &image, Rect area, const unsigned char threshold)
+{
+    if (!area.width || !area.height)
     {
-        if (alphaData[i] > threshold)
+        area = {0, 0, (float) image.width, (float) image.height};
+    }
+    const int width = area.width < 0 ? -area.width : area.width;
+    const int height = area.height < 0 ? -area.height : area.height;
+    auto mask = Mask(width, height);
+    mask.atlas_rect = area;
+
+    // byte distance between pixels and position of alpha inside a pixel
+    int stride = 0;
+    int alpha_offset = 0;
+    switch (image.format)
+    {
+        case rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8:
+            stride = 4;
+            alpha_offset = 3;
+            break;
+        case rl::PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+            stride = 2;
+            alpha_offset = 1;
+            break;
+        case rl::PIXELFORMAT_UNCOMPRESSED_GRAYSCALE:
+            stride = 1;
+            break;
+        default:
+            break;
+    }
+    const auto *data = (const unsigned char *) image.data;
+    const int sx = area.x;
+    const int sy = area.y;
+    for (int y = 0; y < height; ++y)
+    {
+        const int image_y = sy + (area.height < 0 ? height - 1 - y : y);
+        if (image_y < 0 || image_y >= image.height)
+        {
+            continue;
+        }
+        uint64_t *row = mask.Row(y);
+        int x = 0;
+#ifdef RYGAME_SSE2
+        // 16 pixels at a time when the row is read left to right and fully inside the image
+        if ((stride == 1 || stride == 4) && area.width > 0 && sx >= 0 &&
+            sx + width <= image.width && threshold < 255)
+        {
+            const __m128i min = _mm_set1_epi8((char) (threshold + 1));
+            const unsigned char *line = data + (image_y * image.width + sx) * stride;
+            for (; x + 16 <= width; x += 16)
+            {
+                // x is a multiple of 16, the 16 bits never cross a word
+                row[x / 64] |= CompareAlpha16(line + x * stride, stride, min) << (x % 64);
+            }
+        }
+#endif
+        for (; x < width; ++x)
         {
-            maskData[i] = 255;
+            const int image_x = sx + (area.width < 0 ? width - 1 - x : x);
+            if (image_x < 0 || image_x >= image.width)
+            {
+                continue;
+            }
+            const unsigned char alpha =
+                    stride ? data[(image_y * image.width + image_x) * stride + alpha_offset]
+                           : GetImageColor(image, image_x, image_y).a;
+            if (alpha > threshold)
+            {
+                row[x / 64] |= uint64_t{1} << (x % 64);
+            }
         }
     }
-    mask.atlas_rect =
-            Rect{0, 0, (float) frames->render.texture.width, (float) frames->render.texture.height};
+    return mask;
+}
 
-    UnloadImage(alphaImage);
-    UnloadImage(surfImage);
+rg::mask::Mask rg::mask::FromThreshold(
+        const rl::Image &image, const rl::Color color, const rl::Color threshold)
+{
+    auto mask = Mask(image.width, image.height);
+    if (!threshold.r || !threshold.g || !threshold.b || !threshold.a)
+    {
+        // no channel difference is < 0
+        return mask;
+    }
+    const bool rgba = image.format == rl::PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    const auto *data = (const unsigned char *) image.data;
+    for (int y = 0; y < image.height; ++y)
+    {
+        uint64_t *row = mask.Row(y);
+        int x = 0;
+#ifdef RYGAME_SSE2
+        if (rgba)
+        {
+            const __m128i packed_color = _mm_set1_epi32(
+                    (int) (color.r | color.g << 8 | color.b << 16 | (unsigned int) color.a << 24));
+            const __m128i max_diff = _mm_set1_epi32(
+                    (int) ((threshold.r - 1) | (threshold.g - 1) << 8 | (threshold.b - 1) << 16 |
+                           (unsigned int) (threshold.a - 1) << 24));
+            const unsigned char *line = data + y * image.width * 4;
+            for (; x + 16 <= image.width; x += 16)
+            {
+                uint64_t bits = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    bits |= (uint64_t) CompareColor4(line + (x + k * 4) * 4, packed_color, max_diff)
+                            << (k * 4);
+                }
+                row[x / 64] |= bits << (x % 64);
+            }
+        }
+#endif
+        for (; x < image.width; ++x)
+        {
+            const unsigned char *p = data + (y * image.width + x) * 4;
+            const rl::Color pixel =
+                    rgba ? rl::Color{p[0], p[1], p[2], p[3]} : GetImageColor(image, x, y);
+            if (std::abs(pixel.r - color.r) < threshold.r &&
+                std::abs(pixel.g - color.g) < threshold.g &&
+                std::abs(pixel.b - color.b) < threshold.b &&
+                std::abs(pixel.a - color.a) < threshold.a)
+            {
+                row[x / 64] |= uint64_t{1} << (x % 64);
+            }
+        }
+    }
     return mask;
 }
+
+rg::mask::Mask rg::mask::Load(const char *file, const unsigned char threshold)
+{
+    const rl::Image image = rl::LoadImage(file);
+    auto mask = FromImage(image, {}, threshold);
+    UnloadImage(image);
+    return mask;
+}
+
+void rg::mask::ClearCache(const unsigned int texture_id)
+{
+    if (alpha_cache.empty())
+    {
+        return;
+    }
+    if (texture_id)
+    {
+        alpha_cache.erase(texture_id);
+    }
+    else
+    {
+        alpha_cache.clear();
+    }
+}
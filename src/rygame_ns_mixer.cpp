@@ -0,0 +1,135 @@
+#include "rygame.hpp"
+#include "rygame_cl_Rygame.hpp"
+#include <cmath>
+
+
+extern Rygame rygame;
+
+void rg::mixer::set_num_channels(const int count)
+{
+    const size_t size = count > 0 ? count : 0;
+    for (size_t i = size; i < rygame.voices.size(); ++i)
+    {
+        rygame.voices[i].Release();
+    }
+    rygame.voices.resize(size);
+}
+
+int rg::mixer::get_num_channels()
+{
+    return (int) rygame.voices.size();
+}
+
+rg::mixer::Channel rg::mixer::find_channel(const bool force, const int priority)
+{
+    int stolen = -1;
+    for (int i = 0; i < (int) rygame.voices.size(); ++i)
+    {
+        const Channel channel(i);
+        if (!channel.get_busy())
+        {
+            return channel;
+        }
+        const MixerVoice &voice = rygame.voices[i];
+        if (!force || voice.priority > priority)
+        {
+            continue;
+        }
+        if (stolen == -1 || voice.priority < rygame.voices[stolen].priority ||
+            (voice.priority == rygame.voices[stolen].priority &&
+             voice.order < rygame.voices[stolen].order))
+        {
+            stolen = i;
+        }
+    }
+    const Channel channel(stolen);
+    channel.stop();
+    return channel;
+}
+
+void rg::mixer::stop()
+{
+    for (int i = 0; i < (int) rygame.voices.size(); ++i)
+    {
+        Channel(i).stop();
+    }
+}
+
+void rg::mixer::pause()
+{
+    for (int i = 0; i < (int) rygame.voices.size(); ++i)
+    {
+        Channel(i).pause();
+    }
+}
+
+void rg::mixer::unpause()
+{
+    for (int i = 0; i < (int) rygame.voices.size(); ++i)
+    {
+        Channel(i).unpause();
+    }
+}
+
+void rg::mixer::set_listener(const math::Vector2 position)
+{
+    rygame.listener = position;
+}
+
+rg::math::Vector2 rg::mixer::get_listener()
+{
+    return rygame.listener;
+}
+
+void rg::mixer::set_distance(const float min_distance, const float max_distance)
+{
+    rygame.min_distance = std::max(min_distance, 0.0f);
+    rygame.max_distance = std::max(max_distance, rygame.min_distance + 1.0f);
+}
+
+void rg::mixer::Update()
+{
+    for (auto &voice: rygame.voices)
+    {
+        if (!voice.sound || voice.paused)
+        {
+            continue;
+        }
+        if (voice.positional)
+        {
+            SpatializeVoice(voice);
+        }
+        if (voice.loops == 0 || IsSoundPlaying(voice.alias))
+        {
+            continue;
+        }
+        if (voice.loops > 0)
+        {
+            --voice.loops;
+        }
+        PlaySound(voice.alias);
+    }
+}
+
+void SpatializeVoice(MixerVoice &voice)
+{
+    const float dx = voice.position.x - rygame.listener.x;
+    const float dy = voice.position.y - rygame.listener.y;
+    const float distance = std::sqrt(dx * dx + dy * dy);
+    const float fade = (distance - rygame.min_distance) /
+                       (rygame.max_distance - rygame.min_distance);
+    const float gain = 1.0f - std::clamp(fade, 0.0f, 1.0f);
+    // raylib 5.x pan: 0.5 is center, the left channel level grows with pan (1 is left)
+    const float pan = 0.5f - 0.5f * std::clamp(dx / rygame.max_distance, -1.0f, 1.0f);
+    // raylib calls lock the audio thread, skip them if nothing audible changed
+    if (std::abs(gain - voice.gain) > 0.001f)
+    {
+        voice.gain = gain;
+        SetSoundVolume(voice.alias, voice.volume * gain * voice.sound->GetVolume());
+    }
+    if (std::abs(pan - voice.pan) > 0.001f)
+    {
+        voice.pan = pan;
+        SetSoundPan(voice.alias, pan);
+    }
+}
@@ -6,6 +6,24 @@ bool rg::sprite::collide_rect(const Sprite_Ptr &left, const Sprite_Ptr &right)
     return CheckCollisionRecs(left->rect.rectangle, right->rect.rectangle);
 }
 
+bool rg::sprite::collide_mask(const Sprite_Ptr &left, const Sprite_Ptr &right)
+{
+    // broad phase
+    if (!collide_rect(left, right))
+    {
+        return false;
+    }
+    const auto left_mask =
+            left->mask ? left->mask : left->image ? left->image->GetMask() : nullptr;
+    const auto right_mask =
+            right->mask ? right->mask : right->image ? right->image->GetMask() : nullptr;
+    if (!left_mask || !right_mask)
+    {
+        return true;
+    }
+    return left_mask->overlap(*right_mask, right->rect.pos - left->rect.pos);
+}
+
 rg::sprite::collide_rect_ratio::collide_rect_ratio(const float ratio) : ratio(ratio)
 {}
 
@@ -1,4 +1,9 @@
 #include "rygame.hpp"
+#include <atomic>
+#include <thread>
+#ifdef WITH_TMX
+#include <libxml/parser.h>
+#endif // WITH_TMX
 
 
 #ifdef WITH_TMX
@@ -25,7 +30,8 @@ rl::Texture2D *rg::tmx::GetTMXTileTexture(const rl::tmx_tile *tile, Rect *atlas_
 }
 
 std::vector<rg::tmx::TileInfo>
-rg::tmx::GetTMXTiles(const rl::tmx_map *map, const rl::tmx_layer *layer)
+rg::tmx::GetTMXTiles(
+        const rl::tmx_map *map, const rl::tmx_layer *layer, const bool skip_animated)
 {
     std::vector<TileInfo> tiles{};
     tiles.reserve(map->height * map->width);
@@ -35,7 +41,7 @@ rg::tmx::GetTMXTiles(const rl::tmx_map *map, const rl::tmx_layer *layer)
         {
             const unsigned int baseGid = layer->content.gids[y * map->width + x];
             const unsigned int gid = baseGid & TMX_FLIP_BITS_REMOVAL;
-            if (map->tiles[gid])
+            if (map->tiles[gid] && !(skip_animated && map->tiles[gid]->animation))
             {
                 const rl::tmx_tileset *ts = map->tiles[gid]->tileset;
                 Rect atlas_rect{};
@@ -50,14 +56,15 @@ rg::tmx::GetTMXTiles(const rl::tmx_map *map, const rl::tmx_layer *layer)
 }
 
 rg::Surface_Ptr
-rg::tmx::GetTMXLayerSurface(const rl::tmx_map *map, const rl::tmx_layer *layer)
+rg::tmx::GetTMXLayerSurface(
+        const rl::tmx_map *map, const rl::tmx_layer *layer, const bool skip_animated)
 {
     const auto surface = std::make_shared<Surface>(
             (int) (map->width * map->tile_width), (int) (map->height * map->tile_height));
     surface->Fill(rl::BLANK);
     // GetTMXTiles will return many Texture*, but we don't need to unload them here, only
     // at rg::UnloadTMX
-    const std::vector<TileInfo> tiles = GetTMXTiles(map, layer);
+    const std::vector<TileInfo> tiles = GetTMXTiles(map, layer, skip_animated);
     for (const auto &[position, texture, atlas_rect]: tiles)
     {
         surface->Blit(*texture, position, atlas_rect);
@@ -89,16 +96,298 @@ rg::math::Vector2 rg::tmx::GetTMXObjPosition(const rl::tmx_object *object)
     return math::Vector2{x, y};
 }
 
+std::vector<rg::tmx::TileRef>
+rg::tmx::GetTMXTileRefs(const rl::tmx_map *map, const rl::tmx_layer *layer)
+{
+    std::vector<TileRef> tiles{};
+    for (const TileRef &tile: VisibleTiles(
+                 map, layer,
+                 {0, 0, (float) (map->width * map->tile_width),
+                  (float) (map->height * map->tile_height)}))
+    {
+        tiles.push_back(tile);
+    }
+    return tiles;
+}
+
+void rg::tmx::DrawTMXTiles(
+        const Surface_Ptr &surface, const TileTable &table, const rl::tmx_map *map,
+        const rl::tmx_layer *layer, const Rect &area, const math::Vector2 offset)
+{
+    for (const TileRef &tile: VisibleTiles(map, layer, area))
+    {
+        const TileTable::Entry *entry = table.Get(tile.gid);
+        if (entry)
+        {
+            surface->Blit(*entry->texture, table.GetPosition(tile) + offset, entry->atlas_rect);
+        }
+    }
+}
+
+// Worker threads can't create textures, images keep a copy of their path to be loaded later
+static void *DeferTMXImage(const char *path)
+{
+    const size_t size = std::strlen(path) + 1;
+    auto *copy = (char *) rl::MemAlloc(size);
+    std::memcpy(copy, path, size);
+    return copy;
+}
+
+static void FreeDeferredTMXImage(void *address)
+{
+    rl::MemFree(address);
+}
+
+// Maps of all .tmx files in `path`, by file name without extension
+static std::map<std::string, std::string> ListTMXFiles(const char *path)
+{
+    std::map<std::string, std::string> result;
+    for (const auto &dirEntry: std::filesystem::recursive_directory_iterator(path))
+    {
+        if (!dirEntry.is_regular_file() || dirEntry.path().extension() != ".tmx")
+        {
+            continue;
+        }
+        result[dirEntry.path().stem().string()] = dirEntry.path().string();
+    }
+    return result;
+}
+
+// Parses `paths` in parallel. Images are not loaded, their `resource_image` has its path
+// (DeferTMXImage) and must be replaced in the calling thread.
+static std::vector<rl::tmx_map *> ParseTMXFiles(const std::vector<std::string> &paths)
+{
+    std::vector<rl::tmx_map *> result(paths.size(), nullptr);
+    // libxml2 global init is not thread safe, done here before the workers start
+    xmlInitParser();
+    rl::tmx_img_load_func = DeferTMXImage;
+    rl::tmx_img_free_func = FreeDeferredTMXImage;
+
+    std::atomic<size_t> next{0};
+    const auto parse = [&paths, &result, &next]()
+    {
+        for (size_t i = next++; i < paths.size(); i = next++)
+        {
+            result[i] = rl::tmx_load(paths[i].c_str());
+        }
+    };
+    const size_t count = std::min<size_t>(std::thread::hardware_concurrency(), paths.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i)
+    {
+        workers.emplace_back(parse);
+    }
+    // this thread works too
+    parse();
+    for (auto &worker: workers)
+    {
+        worker.join();
+    }
+
+    // same as rl::LoadTMX, so rl::UnloadTMX (tmx_map_free) unloads the textures
+    rl::tmx_img_load_func = rl::LoadTMXImage;
+    rl::tmx_img_free_func = rl::UnloadTMXImage;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (!result[i])
+        {
+            TraceLog(rl::LOG_WARNING, rl::TextFormat("Could not load TMX %s", paths[i].c_str()));
+        }
+    }
+    return result;
+}
+
+// Calls `visit` with each image in `layer` and its siblings, including groups
+template<typename Visit>
+static void ForEachLayerImage(rl::tmx_layer *layer, Visit &visit)
+{
+    for (; layer; layer = layer->next)
+    {
+        if (layer->type == rl::L_IMAGE && layer->content.image)
+        {
+            visit(layer->content.image);
+        }
+        else if (layer->type == rl::L_GROUP)
+        {
+            ForEachLayerImage(layer->content.group_head, visit);
+        }
+    }
+}
+
+// Calls `visit` with each image (tilesets, tiles and image layers) in `map`
+template<typename Visit>
+static void ForEachTMXImage(rl::tmx_map *map, Visit visit)
+{
+    for (const rl::tmx_tileset_list *ts = map->ts_head; ts; ts = ts->next)
+    {
+        rl::tmx_tileset *tileset = ts->tileset;
+        if (tileset->image)
+        {
+            visit(tileset->image);
+        }
+        for (unsigned int i = 0; tileset->tiles && i < tileset->tilecount; ++i)
+        {
+            if (tileset->tiles[i].image)
+            {
+                visit(tileset->tiles[i].image);
+            }
+        }
+    }
+    ForEachLayerImage(map->ly_head, visit);
+}
+
 std::map<std::string, rl::tmx_map *> rg::tmx::LoadTMXMaps(const char *path)
 {
+    std::vector<std::string> names, paths;
+    for (const auto &[name, file]: ListTMXFiles(path))
+    {
+        names.push_back(name);
+        paths.push_back(file);
+    }
+
     std::map<std::string, rl::tmx_map *> result;
-    for (const auto &dirEntry: std::filesystem::recursive_directory_iterator(path))
+    const std::vector<rl::tmx_map *> maps = ParseTMXFiles(paths);
+    for (size_t i = 0; i < maps.size(); ++i)
     {
-        auto filename = dirEntry.path().stem().string();
-        auto entryPath = dirEntry.path().string();
-        result[filename] = rl::LoadTMX(entryPath.c_str());
+        if (!maps[i])
+        {
+            continue;
+        }
+        // same textures as rl::LoadTMX, so rl::UnloadTMX can unload them
+        ForEachTMXImage(
+                maps[i],
+                [](rl::tmx_image *image)
+                {
+                    if (!image->resource_image)
+                    {
+                        return;
+                    }
+                    auto *image_path = (char *) image->resource_image;
+                    image->resource_image = rl::LoadTMXImage(image_path);
+                    FreeDeferredTMXImage(image_path);
+                });
+        result[names[i]] = maps[i];
     }
     return result;
 }
 
+rg::tmx::MapLibrary::MapLibrary(const char *path, const bool lazy) : files(ListTMXFiles(path))
+{
+    if (!lazy)
+    {
+        LoadAll();
+    }
+}
+
+rg::tmx::MapLibrary::~MapLibrary()
+{
+    // textures are shared, they are unloaded once below
+    const auto previous_free = rl::tmx_img_free_func;
+    rl::tmx_img_free_func = nullptr;
+    for (const auto &[name, map]: maps)
+    {
+        if (map)
+        {
+            rl::tmx_map_free(map);
+        }
+    }
+    rl::tmx_img_free_func = previous_free;
+    for (const auto &[image_path, texture]: textures)
+    {
+        rl::UnloadTMXImage(texture);
+    }
+}
+
+rl::tmx_map *rg::tmx::MapLibrary::Get(const std::string &name)
+{
+    const auto loaded = maps.find(name);
+    if (loaded != maps.end())
+    {
+        return loaded->second;
+    }
+    const auto file = files.find(name);
+    if (file == files.end())
+    {
+        TraceLog(rl::LOG_WARNING, rl::TextFormat("MapLibrary has no map %s", name.c_str()));
+        return nullptr;
+    }
+    rl::tmx_map *map = ParseTMXFiles({file->second})[0];
+    if (map)
+    {
+        LoadTextures(map);
+    }
+    maps[name] = map;
+    return map;
+}
+
+void rg::tmx::MapLibrary::LoadAll()
+{
+    std::vector<std::string> names, paths;
+    for (const auto &[name, file]: files)
+    {
+        if (!maps.count(name))
+        {
+            names.push_back(name);
+            paths.push_back(file);
+        }
+    }
+    const std::vector<rl::tmx_map *> parsed = ParseTMXFiles(paths);
+    for (size_t i = 0; i < parsed.size(); ++i)
+    {
+        if (parsed[i])
+        {
+            LoadTextures(parsed[i]);
+        }
+        maps[names[i]] = parsed[i];
+    }
+}
+
+bool rg::tmx::MapLibrary::has(const std::string &name) const
+{
+    return files.count(name);
+}
+
+bool rg::tmx::MapLibrary::IsLoaded(const std::string &name) const
+{
+    return maps.count(name);
+}
+
+std::vector<std::string> rg::tmx::MapLibrary::Names() const
+{
+    std::vector<std::string> result;
+    for (const auto &[name, file]: files)
+    {
+        result.push_back(name);
+    }
+    return result;
+}
+
+unsigned int rg::tmx::MapLibrary::size() const
+{
+    return files.size();
+}
+
+void rg::tmx::MapLibrary::LoadTextures(rl::tmx_map *map)
+{
+    ForEachTMXImage(
+            map,
+            [this](rl::tmx_image *image)
+            {
+                if (!image->resource_image)
+                {
+                    return;
+                }
+                auto *image_path = (char *) image->resource_image;
+                const std::string key =
+                        std::filesystem::path(image_path).lexically_normal().string();
+                rl::Texture2D *&texture = textures[key];
+                if (!texture)
+                {
+                    texture = (rl::Texture2D *) rl::LoadTMXImage(image_path);
+                }
+                image->resource_image = texture;
+                FreeDeferredTMXImage(image_path);
+            });
+}
+
 #endif // WITH_TMX